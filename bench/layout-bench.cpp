@@ -0,0 +1,185 @@
+/* Benchmark of the layout engine, independent of any graphics device.
+ *
+ * Builds synthetic documents of 10^2 to 10^6 nodes from the box classes in
+ * ../inst/include/gridtext, using the StubRenderer for text measurement, and
+ * times box construction, line breaking, layout, and rendering separately. The box
+ * classes use Rcpp objects, so the benchmark runs an embedded R session,
+ * but no R code or graphics device is involved in the timed sections.
+ *
+ * Build and run with `make` and `make run` in this directory. Usage:
+ *
+ *   layout-bench [max_nodes] [repetitions]
+ *
+ * For each corpus size, the best time over all repetitions is reported.
+ */
+
+#include <Rcpp.h>
+#include <Rembedded.h>
+using namespace Rcpp;
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "gridtext/layout.h"
+#include "gridtext/glue.h"
+#include "gridtext/penalty.h"
+#include "gridtext/line-breaker.h"
+#include "gridtext/par-box.h"
+#include "gridtext/rect-box.h"
+#include "gridtext/text-box.h"
+#include "gridtext/vbox.h"
+#include "stub-renderer.h"
+
+// number of nodes (words, spaces, and breaks) in each paragraph
+const size_t par_nodes = 1000;
+// width of the text column, in pt
+const Length column_width = 300;
+
+// deterministic pseudo-random numbers (linear congruential generator)
+class Random {
+  unsigned long m_state;
+public:
+  Random(unsigned long seed = 12345) : m_state(seed) {}
+  size_t next(size_t n) {
+    m_state = (m_state * 1103515245 + 12345) % 2147483648UL;
+    return (m_state >> 8) % n;
+  }
+};
+
+// a pool of words with varying lengths, reused across the corpus
+vector<CharacterVector> make_words(size_t n) {
+  Random rnd(1);
+  vector<CharacterVector> words;
+  for (size_t i = 0; i < n; i++) {
+    size_t len = 1 + rnd.next(10);
+    string w;
+    for (size_t j = 0; j < len; j++) {
+      w += static_cast<char>('a' + rnd.next(26));
+    }
+    words.push_back(CharacterVector::create(w));
+  }
+  return words;
+}
+
+// A paragraph of words separated by spaces, with a forced break every
+// 100 nodes, similar to what the markdown/html parser generates.
+BoxList<StubRenderer> make_paragraph_nodes(size_t n, const vector<CharacterVector> &words, Random &rnd,
+                                           const StubRenderer::GraphicsContext &gp) {
+  BoxList<StubRenderer> nodes;
+  nodes.reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    if (i % 100 == 99) {
+      nodes.push_back(BoxPtr<StubRenderer>(new ForcedBreakPenalty<StubRenderer>()));
+    } else if (i % 2 == 1) {
+      nodes.push_back(BoxPtr<StubRenderer>(new RegularSpaceGlue<StubRenderer>(gp)));
+    } else {
+      nodes.push_back(BoxPtr<StubRenderer>(new TextBox<StubRenderer>(words[rnd.next(words.size())], gp)));
+    }
+  }
+  return nodes;
+}
+
+// The document: one VBox holding a RectBox around a ParBox for every paragraph
+BoxPtr<StubRenderer> make_document(size_t n, const vector<CharacterVector> &words) {
+  Random rnd(2);
+  StubRenderer::GraphicsContext gp(12);
+  BoxList<StubRenderer> pars;
+  for (size_t i = 0; i < n; i += par_nodes) {
+    size_t m = (n - i < par_nodes) ? n - i : par_nodes;
+    BoxPtr<StubRenderer> par(
+      new ParBox<StubRenderer>(make_paragraph_nodes(m, words, rnd, gp), 14.4, SizePolicy::expand)
+    );
+    pars.push_back(BoxPtr<StubRenderer>(new RectBox<StubRenderer>(
+      par, 0, 0, Margin(2, 2, 2, 2), Margin(5, 5, 5, 5), gp, 0, 1,
+      SizePolicy::expand, SizePolicy::native
+    )));
+  }
+  return BoxPtr<StubRenderer>(new VBox<StubRenderer>(pars, column_width, 0, 1, SizePolicy::fixed));
+}
+
+double seconds_since(chrono::steady_clock::time_point start) {
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+struct Timings {
+  double construct, line_break, layout, render;
+  size_t text_count, rect_count;
+  double checksum;
+};
+
+Timings run(size_t n, const vector<CharacterVector> &words) {
+  Timings t;
+  auto start = chrono::steady_clock::now();
+  BoxPtr<StubRenderer> doc = make_document(n, words);
+  t.construct = seconds_since(start);
+
+  // line breaking by itself, on a single list holding all nodes
+  Random rnd(3);
+  StubRenderer::GraphicsContext gp(12);
+  BoxList<StubRenderer> nodes = make_paragraph_nodes(n, words, rnd, gp);
+  for (auto i_node = nodes.begin(); i_node != nodes.end(); i_node++) {
+    (*i_node)->calc_layout(column_width, 0);
+  }
+  vector<Length> line_lengths = {column_width};
+  vector<LineBreakInfo> line_breaks;
+  start = chrono::steady_clock::now();
+  LineBreaker<StubRenderer> lb(nodes, line_lengths, true);
+  lb.compute_line_breaks(line_breaks);
+  t.line_break = seconds_since(start);
+
+  start = chrono::steady_clock::now();
+  doc->calc_layout(column_width, 0);
+  doc->place(0, 0);
+  t.layout = seconds_since(start);
+
+  StubRenderer r;
+  start = chrono::steady_clock::now();
+  doc->render(r, 0, 0);
+  t.render = seconds_since(start);
+
+  t.text_count = r.text_count();
+  t.rect_count = r.rect_count();
+  t.checksum = r.checksum();
+  return t;
+}
+
+int main(int argc, char **argv) {
+  size_t max_nodes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+  int reps = argc > 2 ? atoi(argv[2]) : 3;
+
+  const char *r_argv[] = {"layout-bench", "--vanilla", "--silent", "--no-save"};
+  Rf_initEmbeddedR(4, const_cast<char **>(r_argv));
+
+  // Rcpp objects call into the Rcpp package, so it needs to be loaded
+  SEXP call = PROTECT(Rf_lang2(Rf_install("loadNamespace"), Rf_mkString("Rcpp")));
+  Rf_eval(call, R_GlobalEnv);
+  UNPROTECT(1);
+
+  {
+    vector<CharacterVector> words = make_words(1000);
+
+    printf("%10s %12s %12s %12s %12s %14s %8s %8s %14s\n",
+           "nodes", "construct_s", "linebreak_s", "layout_s", "render_s",
+           "nodes_per_s", "texts", "rects", "checksum");
+    for (size_t n = 100; n <= max_nodes; n *= 10) {
+      Timings best = run(n, words);
+      for (int i = 1; i < reps; i++) {
+        Timings t = run(n, words);
+        if (t.construct < best.construct) best.construct = t.construct;
+        if (t.line_break < best.line_break) best.line_break = t.line_break;
+        if (t.layout < best.layout) best.layout = t.layout;
+        if (t.render < best.render) best.render = t.render;
+      }
+      printf("%10zu %12.6f %12.6f %12.6f %12.6f %14.0f %8zu %8zu %14.1f\n",
+             n, best.construct, best.line_break, best.layout, best.render,
+             n / (best.layout + best.render), best.text_count, best.rect_count, best.checksum);
+    }
+  }
+
+  Rf_endEmbeddedR(0);
+  return 0;
+}
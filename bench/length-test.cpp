@@ -0,0 +1,115 @@
+/* Tests of the Length type and of line breaking at the exact line length.
+ *
+ * Lengths are only stored as scaled points if GRIDTEXT_SCALED_POINTS is
+ * defined, which the R package doesn't do by default, so this code path isn't
+ * covered by the package tests. `make check` in this directory builds and runs
+ * this program both with and without scaled points. Like the benchmark, the
+ * program runs an embedded R session for the Rcpp objects used by the boxes,
+ * and it measures text with the StubRenderer.
+ *
+ * Prints one line per failed check and exits with status 1 if there were any.
+ */
+
+#include <Rcpp.h>
+#include <Rembedded.h>
+using namespace Rcpp;
+
+#include <cstdio>
+#include <vector>
+using namespace std;
+
+#include "gridtext/length.h"
+#include "gridtext/layout.h"
+#include "gridtext/glue.h"
+#include "gridtext/line-breaker.h"
+#include "gridtext/text-box.h"
+#include "stub-renderer.h"
+
+int failures = 0;
+
+void check(bool ok, const char *what) {
+  if (!ok) {
+    printf("FAILED: %s\n", what);
+    failures++;
+  }
+}
+
+// the smallest length representable with scaled points
+#ifdef GRIDTEXT_SCALED_POINTS
+const bool scaled_points = true;
+const Length one_sp = Length::from_sp(1);
+#else
+const bool scaled_points = false;
+const Length one_sp = 1 / 65536.0;
+#endif
+
+void test_length() {
+  Length a = 0.1, b = 0.2, c = 0.3;
+  check(static_cast<double>(Length(12)) == 12, "whole pt convert to and from Length exactly");
+  check(fits_within(a, b), "shorter material fits");
+  check(!fits_within(b, a), "longer material doesn't fit");
+
+  if (scaled_points) {
+    check((a + b) + c == a + (b + c), "sums of lengths don't depend on the order of additions");
+    check(a + b - b == a, "subtracting a length undoes adding it");
+    check(fits_within(a + b, a + b), "material filling the line exactly fits");
+    check(!fits_within(a + b + one_sp, a + b), "material 1sp too wide doesn't fit");
+  } else {
+    check(!fits_within(a + b, a + b), "material filling the line exactly doesn't fit with doubles");
+  }
+}
+
+// breaks the nodes into lines of length `linelen` and returns the number of lines
+size_t count_lines(const BoxList<StubRenderer> &nodes, Length linelen) {
+  vector<Length> line_lengths = {linelen};
+  vector<LineBreakInfo> line_breaks;
+  LineBreaker<StubRenderer> lb(nodes, line_lengths, true);
+  lb.compute_line_breaks(line_breaks);
+  return line_breaks.size();
+}
+
+void test_exact_line() {
+  StubRenderer::GraphicsContext gp(10.3);
+  const char *words[] = {"gridtext", "lays", "out", "text", "in", "exact", "scaled", "points"};
+  BoxList<StubRenderer> nodes;
+  for (size_t i = 0; i < 8; i++) {
+    if (i > 0) {
+      nodes.push_back(BoxPtr<StubRenderer>(new RegularSpaceGlue<StubRenderer>(gp)));
+    }
+    nodes.push_back(BoxPtr<StubRenderer>(new TextBox<StubRenderer>(CharacterVector::create(words[i]), gp)));
+  }
+  for (auto i_node = nodes.begin(); i_node != nodes.end(); i_node++) {
+    (*i_node)->calc_layout(0, 0);
+  }
+
+  vector<Length> line_lengths = {0};
+  LineBreaker<StubRenderer> lb(nodes, line_lengths, true);
+  Length width = lb.sum_width(nodes.size());
+
+  check(count_lines(nodes, 2 * width) == 1, "a short paragraph is set in one line");
+  check(count_lines(nodes, 0.9 * width) == 2, "a paragraph that is too long is broken");
+  if (scaled_points) {
+    check(count_lines(nodes, width) == 1, "a line filling the line length exactly is accepted");
+    check(count_lines(nodes, width - one_sp) == 2, "a line 1sp too long is broken");
+  } else {
+    check(count_lines(nodes, width) == 2, "with doubles, a line filling the line length exactly is broken");
+  }
+}
+
+int main() {
+  const char *r_argv[] = {"length-test", "--vanilla", "--silent", "--no-save"};
+  Rf_initEmbeddedR(4, const_cast<char **>(r_argv));
+
+  // Rcpp objects call into the Rcpp package, so it needs to be loaded
+  SEXP call = PROTECT(Rf_lang2(Rf_install("loadNamespace"), Rf_mkString("Rcpp")));
+  Rf_eval(call, R_GlobalEnv);
+  UNPROTECT(1);
+
+  test_length();
+  test_exact_line();
+
+  printf("%s lengths: %s\n", scaled_points ? "scaled-point" : "double", failures ? "FAILED" : "ok");
+
+  Rf_endEmbeddedR(0);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,43 @@
+#ifndef GRIDTEXT_H
+#define GRIDTEXT_H
+
+/* Public C++ interface of gridtext.
+ *
+ * Other packages can build, lay out, and render box trees from compiled code,
+ * without calling back into R for every node. To do so, add gridtext to both
+ * `LinkingTo` and `Imports` in the DESCRIPTION file (the latter makes sure
+ * gridtext is loaded, and with it the C-callables this interface relies on),
+ * and include this file.
+ *
+ * Box trees consist of the node classes (TextBox, RectBox, VBox, ParBox,
+ * RasterBox, NullBox, glue, and penalties), which are templated on the
+ * renderer. To draw with grid, use GridRenderer:
+ *
+ *   BoxPtr<GridRenderer> par = gridtext::make_par_box(nodes, 14);
+ *   par->calc_layout(200, 0);
+ *   par->place(0, 0);
+ *   GridRenderer gr;
+ *   par->render(gr, 0, 0);
+ *   List grobs = gr.collect_grobs();
+ *
+ * All lengths are given in pt. Graphics contexts are grid gpar() lists, and text
+ * is measured with the current graphics device, as in gridtext itself. The
+ * interface is not stable yet; the headers need to match the installed version
+ * of gridtext.
+ */
+
+#include "gridtext/length.h"
+#include "gridtext/layout.h"
+#include "gridtext/glue.h"
+#include "gridtext/penalty.h"
+#include "gridtext/line-breaker.h"
+#include "gridtext/null-box.h"
+#include "gridtext/par-box.h"
+#include "gridtext/raster-box.h"
+#include "gridtext/rect-box.h"
+#include "gridtext/text-box.h"
+#include "gridtext/vbox.h"
+#include "gridtext/grid-renderer.h"
+#include "gridtext/builder.h"
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef GRIDTEXT_BUILDER_H
+#define GRIDTEXT_BUILDER_H
+
+#include <Rcpp.h>
+using namespace Rcpp;
+
+#include "grid.h"
+#include "layout.h"
+#include "grid-renderer.h"
+
+/* Constructors for box nodes, for use by the compiled code of other packages.
+ * These call the C-callables registered by gridtext, and they are equivalent
+ * to the corresponding `bl_make_*()` R functions, including their default
+ * arguments. The nodes returned are external pointers of class "bl_node",
+ * just like the ones created in R, so they can be handed back to R. Like all
+ * nodes, they don't survive serialization. Errors are thrown as
+ * Rcpp::exception.
+ *
+ * Nodes can also be created directly from the box classes, e.g.,
+ * `BoxPtr<GridRenderer>(new TextBox<GridRenderer>(label, gp))`, but such
+ * nodes lack the class attribute, so the `bl_*()` R functions reject them.
+ */
+
+namespace gridtext {
+
+inline BoxPtr<GridRenderer> make_null_box(double width_pt = 0, double height_pt = 0) {
+  typedef SEXP (*Fun)(SEXP, SEXP);
+  static Fun fun = gridtext_callable<Fun>("bl_make_null_box");
+  return BoxPtr<GridRenderer>(gridtext_check_result(fun(
+    NumericVector(1, width_pt), NumericVector(1, height_pt)
+  )));
+}
+
+inline BoxPtr<GridRenderer> make_par_box(const List &node_list, double vspacing_pt, String width_policy = "native",
+                                         RObject hjust = R_NilValue, int max_lines = 0,
+                                         RObject ellipsis = R_NilValue) {
+  typedef SEXP (*Fun)(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+  static Fun fun = gridtext_callable<Fun>("bl_make_par_box");
+  return BoxPtr<GridRenderer>(gridtext_check_result(fun(
+    node_list, NumericVector(1, vspacing_pt), CharacterVector::create(width_policy),
+    hjust, IntegerVector::create(max_lines), ellipsis
+  )));
+}
+
+inline BoxPtr<GridRenderer> make_rect_box(RObject content, double width_pt, double height_pt,
+                                          NumericVector margin, NumericVector padding, List gp,
+                                          double content_hjust = 0, double content_vjust = 1,
+                                          String width_policy = "fixed", String height_policy = "fixed",
+                                          double r = 0) {
+  typedef SEXP (*Fun)(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+  static Fun fun = gridtext_callable<Fun>("bl_make_rect_box");
+  return BoxPtr<GridRenderer>(gridtext_check_result(fun(
+    content, NumericVector(1, width_pt), NumericVector(1, height_pt), margin, padding, gp,
+    NumericVector(1, content_hjust), NumericVector(1, content_vjust),
+    CharacterVector::create(width_policy), CharacterVector::create(height_policy), NumericVector(1, r)
+  )));
+}
+
+inline BoxPtr<GridRenderer> make_text_box(const CharacterVector &label, List gp, double voff_pt = 0) {
+  typedef SEXP (*Fun)(SEXP, SEXP, SEXP);
+  static Fun fun = gridtext_callable<Fun>("bl_make_text_box");
+  return BoxPtr<GridRenderer>(gridtext_check_result(fun(label, gp, NumericVector(1, voff_pt))));
+}
+
+inline BoxPtr<GridRenderer> make_raster_box(RObject image, double width_pt = 0, double height_pt = 0,
+                                            String width_policy = "native", String height_policy = "native",
+                                            bool respect_aspect = true, bool interpolate = true,
+                                            double dpi = 150, List gp = R_NilValue) {
+  typedef SEXP (*Fun)(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+  static Fun fun = gridtext_callable<Fun>("bl_make_raster_box");
+  return BoxPtr<GridRenderer>(gridtext_check_result(fun(
+    image, NumericVector(1, width_pt), NumericVector(1, height_pt),
+    CharacterVector::create(width_policy), CharacterVector::create(height_policy),
+    LogicalVector(1, respect_aspect), LogicalVector(1, interpolate), NumericVector(1, dpi), gp
+  )));
+}
+
+inline BoxPtr<GridRenderer> make_vbox(const List &node_list, double width_pt = 0, double hjust = 0,
+                                      double vjust = 1, String width_policy = "native") {
+  typedef SEXP (*Fun)(SEXP, SEXP, SEXP, SEXP, SEXP);
+  static Fun fun = gridtext_callable<Fun>("bl_make_vbox");
+  return BoxPtr<GridRenderer>(gridtext_check_result(fun(
+    node_list, NumericVector(1, width_pt), NumericVector(1, hjust), NumericVector(1, vjust),
+    CharacterVector::create(width_policy)
+  )));
+}
+
+inline BoxPtr<GridRenderer> make_regular_space_glue(List gp, double stretch_ratio = 0.5,
+                                                    double shrink_ratio = 0.333333) {
+  typedef SEXP (*Fun)(SEXP, SEXP, SEXP);
+  static Fun fun = gridtext_callable<Fun>("bl_make_regular_space_glue");
+  return BoxPtr<GridRenderer>(gridtext_check_result(fun(
+    gp, NumericVector(1, stretch_ratio), NumericVector(1, shrink_ratio)
+  )));
+}
+
+inline BoxPtr<GridRenderer> make_forced_break_penalty() {
+  typedef SEXP (*Fun)();
+  static Fun fun = gridtext_callable<Fun>("bl_make_forced_break_penalty");
+  return BoxPtr<GridRenderer>(gridtext_check_result(fun()));
+}
+
+inline BoxPtr<GridRenderer> make_never_break_penalty() {
+  typedef SEXP (*Fun)();
+  static Fun fun = gridtext_callable<Fun>("bl_make_never_break_penalty");
+  return BoxPtr<GridRenderer>(gridtext_check_result(fun()));
+}
+
+} // namespace gridtext
+
+#endif
@@ -1,5 +1,5 @@
-#ifndef GLUE_H
-#define GLUE_H
+#ifndef GRIDTEXT_GLUE_H
+#define GRIDTEXT_GLUE_H
 
 #include <Rcpp.h>
 using namespace Rcpp;
@@ -55,6 +55,9 @@ class RegularSpaceGlue : public Glue<Renderer> {
 private:
   typename Renderer::GraphicsContext m_gp;
   double m_stretch_ratio, m_shrink_ratio; // used to convert width of space character into stretch and shrink
+  double m_scale; // font scale
+  Length m_space; // width of a space at the original font size
+  bool m_measured;
 
   // pull protected members from superclass explicitly into scope
   using Glue<Renderer>::m_width;
@@ -64,13 +67,20 @@ private:
 public:
   RegularSpaceGlue(const typename Renderer::GraphicsContext &gp,
                    double stretch_ratio = 0.5, double shrink_ratio = 0.333333) :
-    m_gp(gp), m_stretch_ratio(stretch_ratio), m_shrink_ratio(shrink_ratio) {}
+    m_gp(gp), m_stretch_ratio(stretch_ratio), m_shrink_ratio(shrink_ratio),
+    m_scale(1), m_space(0), m_measured(false) {}
   ~RegularSpaceGlue() {}
 
+  void set_font_scale(double scale) { m_scale = scale; }
+
   // width, stretch, and shrink are only defined once `calc_layout()` has been called
   void calc_layout(Length, Length) {
-    TextDetails td = Renderer::text_details(" ", m_gp);
-    m_width = td.space;
+    // as in TextBox, scaled font sizes reuse the previous measurement
+    if (m_scale == 1 || !m_measured) {
+      m_space = Renderer::text_details(" ", m_gp).space;
+      m_measured = true;
+    }
+    m_width = m_scale * m_space;
     m_stretch = m_width * m_stretch_ratio;
     m_shrink = m_width * m_shrink_ratio;
   }
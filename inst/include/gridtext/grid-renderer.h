@@ -0,0 +1,330 @@
+#ifndef GRIDTEXT_GRID_RENDERER_H
+#define GRIDTEXT_GRID_RENDERER_H
+
+#include <Rcpp.h>
+using namespace Rcpp;
+
+#include <vector>
+#include <utility>
+#include <cmath>
+
+#include "grid.h"
+#include "length.h"
+#include "layout.h"
+#include "profiler.h"
+
+class GridRenderer {
+public:
+  // GridRenderer stores its graphics context in a grid gpar() list
+  typedef List GraphicsContext;
+
+private:
+  vector<RObject> m_grobs;
+
+  // if `true`, consecutive text draws sharing the same graphics context
+  // are collected into a single, vectorized text grob
+  bool m_coalesce_text;
+  // the current run of text labels waiting to be turned into a grob
+  vector<CharacterVector> m_run_labels;
+  vector<Length> m_run_x, m_run_y;
+  GraphicsContext m_run_gp;
+
+  // if `true`, consecutive simple rects sharing the same graphics context
+  // are collected into a single, vectorized rect grob
+  bool m_batch_rects;
+  // the current batch of rects waiting to be turned into a grob
+  vector<Length> m_batch_x, m_batch_y, m_batch_width, m_batch_height;
+  GraphicsContext m_batch_gp;
+
+  // if larger than 0, raster images are downsampled to this resolution,
+  // in dots per inch, before being drawn
+  double m_raster_dpi;
+
+  // draw/skip decisions for the graphics contexts seen so far
+  vector<pair<GraphicsContext, bool>> m_gp_visible;
+
+  // optional clip rectangle; boxes entirely outside of it don't need to be rendered
+  bool m_clip;
+  Length m_clip_x0, m_clip_y0, m_clip_x1, m_clip_y1;
+
+  // turn the current run of text labels into a grob
+  void flush_text_run() {
+    if (m_run_labels.empty()) {
+      return;
+    }
+
+    if (m_run_labels.size() == 1) {
+      // a run of one is just a regular text grob
+      m_grobs.push_back(
+        text_grob(m_run_labels[0], NumericVector(1, m_run_x[0]), NumericVector(1, m_run_y[0]), m_run_gp, R_NilValue)
+      );
+    } else {
+      CharacterVector labels(m_run_labels.size());
+      for (size_t i = 0; i < m_run_labels.size(); i++) {
+        labels[i] = m_run_labels[i][0];
+      }
+      m_grobs.push_back(
+        text_grob_vectorized(
+          labels, NumericVector(m_run_x.begin(), m_run_x.end()),
+          NumericVector(m_run_y.begin(), m_run_y.end()), m_run_gp, R_NilValue
+        )
+      );
+    }
+
+    m_run_labels.clear();
+    m_run_x.clear();
+    m_run_y.clear();
+  }
+
+  // turn the current batch of rects into a grob
+  void flush_rect_batch() {
+    if (m_batch_x.empty()) {
+      return;
+    }
+
+    if (m_batch_x.size() == 1) {
+      m_grobs.push_back(
+        rect_grob(
+          NumericVector(1, m_batch_x[0]), NumericVector(1, m_batch_y[0]),
+          NumericVector(1, m_batch_width[0]), NumericVector(1, m_batch_height[0]), m_batch_gp, R_NilValue
+        )
+      );
+    } else {
+      m_grobs.push_back(
+        rect_grob_vectorized(
+          NumericVector(m_batch_x.begin(), m_batch_x.end()), NumericVector(m_batch_y.begin(), m_batch_y.end()),
+          NumericVector(m_batch_width.begin(), m_batch_width.end()),
+          NumericVector(m_batch_height.begin(), m_batch_height.end()), m_batch_gp, R_NilValue
+        )
+      );
+    }
+
+    m_batch_x.clear();
+    m_batch_y.clear();
+    m_batch_width.clear();
+    m_batch_height.clear();
+  }
+
+  // emit everything that is currently pending
+  void flush() {
+    flush_text_run();
+    flush_rect_batch();
+  }
+
+protected:
+  // converts an image into a raster, downsampled if requested, for drawing at
+  // the given width and height
+  RObject prepare_raster(RObject image, Length width, Length height) {
+    if (m_raster_dpi <= 0) {
+      return image;
+    }
+
+    // there's no point in sending more pixels to the device than it can show;
+    // there are 72.27 pt in each in, and the small offset guards against rounding
+    // up pixel counts that are whole numbers up to rounding error
+    return downsample_raster(
+      as_raster(image), (int) ceil(width * m_raster_dpi / 72.27 - 1e-6),
+      (int) ceil(height * m_raster_dpi / 72.27 - 1e-6)
+    );
+  }
+
+  RObject gpar_lookup(List gp, const char* element) {
+    if (!gp.containsElementNamed(element)) {
+      return R_NilValue;
+    } else {
+      return gp[element];
+    }
+  }
+
+  // determines whether a rect drawn with the graphics context gp would show at all
+  bool compute_visibility(const GraphicsContext &gp) {
+    // default assumption is we don't have a fill color but we do have line color and type
+    bool have_fill_col = false;
+    bool have_line_col = true;
+    bool have_line_type = true;
+    RObject fill_obj = gpar_lookup(gp, "fill");
+
+    if (!fill_obj.isNULL()) {
+      CharacterVector fill(fill_obj);
+      if (fill.size() > 0 && !CharacterVector::is_na(fill[0])) {
+        have_fill_col = true;
+      }
+    }
+
+    // if we have a fill color, further checks don't matter
+    if (!have_fill_col) {
+      RObject color = gpar_lookup(gp, "col");
+      if (!color.isNULL()) {
+        CharacterVector col(color);
+        if (col.size() == 0 || CharacterVector::is_na(col[0])) {
+          have_line_col = false;
+        }
+      }
+    }
+
+    // if we don't have a fill color but do have a line color,
+    // need to check line type
+    if (!have_fill_col && have_line_col) {
+      RObject linetype = gpar_lookup(gp, "lty");
+      if (!linetype.isNULL()) {
+        NumericVector lty(linetype);
+        if (lty.size() == 0 || lty[0] == 0) {
+          have_line_type = false;
+        }
+      }
+    }
+
+    return have_fill_col || (have_line_col && have_line_type);
+  }
+
+  // cached version of compute_visibility(); graphics contexts are
+  // compared by identity, and we hold on to each one we have seen
+  // so its address cannot get reused
+  bool is_visible(const GraphicsContext &gp) {
+    for (auto i_gp = m_gp_visible.begin(); i_gp != m_gp_visible.end(); i_gp++) {
+      if (static_cast<SEXP>(i_gp->first) == static_cast<SEXP>(gp)) {
+        return i_gp->second;
+      }
+    }
+    bool visible = compute_visibility(gp);
+    m_gp_visible.emplace_back(gp, visible);
+    return visible;
+  }
+
+public:
+  GridRenderer(bool coalesce_text = false, bool batch_rects = false, double raster_dpi = 0) :
+    m_coalesce_text(coalesce_text), m_batch_rects(batch_rects), m_raster_dpi(raster_dpi),
+    m_clip(false), m_clip_x0(0), m_clip_y0(0), m_clip_x1(0), m_clip_y1(0) {
+  }
+  virtual ~GridRenderer() {};
+
+  static TextDetails text_details(const CharacterVector &label, GraphicsContext gp) {
+    GRIDTEXT_PROFILE(text_measurement);
+
+    // call R function to look up text info
+    Environment env = Environment::namespace_env("gridtext");
+
+    Function td = env["text_details"];
+    List info = td(label, gp);
+    RObject width_pt = info["width_pt"];
+    RObject ascent_pt = info["ascent_pt"];
+    RObject descent_pt = info["descent_pt"];
+    RObject space_pt = info["space_pt"];
+    return TextDetails(
+      NumericVector(width_pt)[0],
+      NumericVector(ascent_pt)[0],
+      NumericVector(descent_pt)[0],
+      NumericVector(space_pt)[0]
+    );
+  }
+
+  // sets the clip rectangle, from the lower left corner (x0, y0) to the upper right corner (x1, y1)
+  void set_clip(Length x0, Length y0, Length x1, Length y1) {
+    m_clip = true;
+    m_clip_x0 = x0;
+    m_clip_y0 = y0;
+    m_clip_x1 = x1;
+    m_clip_y1 = y1;
+  }
+
+  // returns true if the rectangle from (x0, y0) to (x1, y1) lies entirely outside
+  // the clip rectangle, so that anything inside of it can be skipped during rendering
+  bool is_clipped(Length x0, Length y0, Length x1, Length y1) const {
+    return m_clip && (x1 < m_clip_x0 || x0 > m_clip_x1 || y1 < m_clip_y0 || y0 > m_clip_y1);
+  }
+
+  // The drawing primitives are virtual, so that renderers producing other kinds of
+  // output can derive from GridRenderer and draw the box trees built from R.
+
+  virtual void text(const CharacterVector &label, Length x, Length y, const GraphicsContext &gp) {
+    if (!m_coalesce_text) {
+      flush_rect_batch(); // preserve drawing order
+      m_grobs.push_back(text_grob(label, NumericVector(1, x), NumericVector(1, y), gp, R_NilValue));
+      return;
+    }
+
+    // graphics contexts are compared by identity, which is cheap and
+    // catches all text generated from the same drawing context
+    flush_rect_batch(); // preserve drawing order
+    if (!m_run_labels.empty() && static_cast<SEXP>(gp) != static_cast<SEXP>(m_run_gp)) {
+      flush_text_run();
+    }
+    m_run_gp = gp;
+    m_run_labels.push_back(label);
+    m_run_x.push_back(x);
+    m_run_y.push_back(y);
+  }
+
+  virtual void raster(RObject image, Length x, Length y, Length width, Length height, bool interpolate = true,
+              const GraphicsContext &gp = R_NilValue) {
+    if (!image.isNULL()) {
+      flush(); // preserve drawing order
+      image = prepare_raster(image, width, height);
+      m_grobs.push_back(
+        raster_grob(
+          image, NumericVector(1, x), NumericVector(1, y),
+          NumericVector(1, width), NumericVector(1, height), LogicalVector(1, interpolate, gp),
+          R_NilValue, R_NilValue
+        )
+      );
+    }
+  }
+
+  virtual void rect(Length x, Length y, Length width, Length height, const GraphicsContext &gp, Length r = 0) {
+    // skip drawing if nothing would show anyways
+    if (!is_visible(gp)) {
+      return;
+    }
+
+    // now that we know we should draw, go ahead
+    flush_text_run(); // preserve drawing order
+
+    // simple rects with the same graphics context are collected into one grob
+    if (m_batch_rects && r < 0.01) {
+      if (!m_batch_x.empty() && static_cast<SEXP>(gp) != static_cast<SEXP>(m_batch_gp)) {
+        flush_rect_batch();
+      }
+      m_batch_gp = gp;
+      m_batch_x.push_back(x);
+      m_batch_y.push_back(y);
+      m_batch_width.push_back(width);
+      m_batch_height.push_back(height);
+      return;
+    }
+    flush_rect_batch();
+
+    NumericVector xv(1, x), yv(1, y), widthv(1, width), heightv(1, height);
+
+    // draw simple rect grob or rounded rect grob depending on provided radius
+    if (r < 0.01) {
+      m_grobs.push_back(rect_grob(xv, yv, widthv, heightv, gp, R_NilValue));
+    } else {
+      NumericVector rv(1, r);
+      m_grobs.push_back(roundrect_grob(xv, yv, widthv, heightv, rv, gp, R_NilValue));
+    }
+  }
+
+
+  List collect_grobs() {
+    flush();
+
+    // turn vector of grobs into list; doing it this way avoids
+    // List.push_back() which is slow.
+    List out(m_grobs.size());
+
+    size_t i = 0;
+    for (auto i_grob = m_grobs.begin(); i_grob != m_grobs.end(); i_grob++) {
+      out[i] = *i_grob;
+      i++;
+    }
+    // clear internal grobs list; the renderer is reset with each collect_grobs() call
+    m_grobs.clear();
+
+    // turn list into gList to keep grid happy
+    out.attr("class") = "gList";
+
+    return out;
+  }
+};
+
+#endif
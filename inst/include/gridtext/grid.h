@@ -0,0 +1,124 @@
+#ifndef GRIDTEXT_GRID_H
+#define GRIDTEXT_GRID_H
+
+#include <Rcpp.h>
+#include <R_ext/Rdynload.h>
+using namespace Rcpp;
+
+#include <string>
+using namespace std;
+
+#include "length.h"
+
+// This file declares a number of convenience functions that allow for the rapid construction
+// or manipulation of grid units or grobs. Each could be replaced by a simple R call to a
+// corresponding grid function (e.g., unit_pt(x) is equivalent to unit(x, "pt")), but in general
+// the C++ version here is much faster, in particular because it skips extensive input validation.
+//
+// The functions are defined, and exported to R, in src/grid.cpp; see there for their
+// default arguments. Code that is compiled as part of gridtext needs to define
+// GRIDTEXT_INTERNAL (see src/Makevars). Code in other packages instead calls the
+// functions via C-callables registered by gridtext.
+
+#ifdef GRIDTEXT_INTERNAL
+
+NumericVector unit_pt(NumericVector x);
+NumericVector unit_pt(Length x);
+List gpar_empty();
+List text_grob(CharacterVector label, NumericVector x_pt, NumericVector y_pt, RObject gp, RObject name);
+List text_grob_vectorized(CharacterVector label, NumericVector x_pt, NumericVector y_pt,
+                          RObject gp, RObject name);
+RObject as_raster(RObject image);
+RObject downsample_raster(RObject image, int width_px, int height_px);
+List raster_grob(RObject image, NumericVector x_pt, NumericVector y_pt, NumericVector width_pt,
+                 NumericVector height_pt, LogicalVector interpolate, RObject gp, RObject name);
+List rect_grob(NumericVector x_pt, NumericVector y_pt, NumericVector width_pt, NumericVector height_pt,
+               RObject gp, RObject name);
+List rect_grob_vectorized(NumericVector x_pt, NumericVector y_pt, NumericVector width_pt,
+                          NumericVector height_pt, RObject gp, RObject name);
+List roundrect_grob(NumericVector x_pt, NumericVector y_pt, NumericVector width_pt, NumericVector height_pt,
+                    NumericVector r_pt, RObject gp, RObject name);
+List viewport_ll(RObject x, RObject y, double angle, RObject name);
+RObject set_grob_coords(RObject grob, NumericVector x, NumericVector y);
+
+#else
+
+// returns the C-callable `name` registered by gridtext; all C-callables take and return SEXPs
+template <class F>
+F gridtext_callable(const char *name) {
+  return reinterpret_cast<F>(R_GetCCallable("gridtext", name));
+}
+
+// The C-callables don't raise R errors, which would longjmp through the calling C++
+// code. They instead return errors as a "try-error" object, which is rethrown here.
+// R-level jumps and user interrupts are rethrown as the Rcpp exceptions they came
+// from, so that they continue once they reach R.
+inline SEXP gridtext_check_result(SEXP result) {
+  if (Rf_inherits(result, "try-error")) {
+    throw Rcpp::exception(CHAR(STRING_ELT(result, 0)), false);
+  }
+  if (Rf_inherits(result, "gridtext_longjump")) {
+    throw Rcpp::LongjumpException(VECTOR_ELT(result, 0));
+  }
+  if (Rf_inherits(result, "gridtext_interrupt")) {
+    throw Rcpp::internal::InterruptedException();
+  }
+  return result;
+}
+
+inline List text_grob(CharacterVector label, NumericVector x_pt, NumericVector y_pt, RObject gp, RObject name) {
+  typedef SEXP (*Fun)(SEXP, SEXP, SEXP, SEXP, SEXP);
+  static Fun fun = gridtext_callable<Fun>("text_grob");
+  return gridtext_check_result(fun(label, x_pt, y_pt, gp, name));
+}
+
+inline List text_grob_vectorized(CharacterVector label, NumericVector x_pt, NumericVector y_pt,
+                                 RObject gp, RObject name) {
+  typedef SEXP (*Fun)(SEXP, SEXP, SEXP, SEXP, SEXP);
+  static Fun fun = gridtext_callable<Fun>("text_grob_vectorized");
+  return gridtext_check_result(fun(label, x_pt, y_pt, gp, name));
+}
+
+inline RObject as_raster(RObject image) {
+  typedef SEXP (*Fun)(SEXP);
+  static Fun fun = gridtext_callable<Fun>("as_raster");
+  return gridtext_check_result(fun(image));
+}
+
+inline RObject downsample_raster(RObject image, int width_px, int height_px) {
+  typedef SEXP (*Fun)(SEXP, SEXP, SEXP);
+  static Fun fun = gridtext_callable<Fun>("downsample_raster");
+  return gridtext_check_result(fun(image, IntegerVector::create(width_px), IntegerVector::create(height_px)));
+}
+
+inline List raster_grob(RObject image, NumericVector x_pt, NumericVector y_pt, NumericVector width_pt,
+                        NumericVector height_pt, LogicalVector interpolate, RObject gp, RObject name) {
+  typedef SEXP (*Fun)(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+  static Fun fun = gridtext_callable<Fun>("raster_grob");
+  return gridtext_check_result(fun(image, x_pt, y_pt, width_pt, height_pt, interpolate, gp, name));
+}
+
+inline List rect_grob(NumericVector x_pt, NumericVector y_pt, NumericVector width_pt, NumericVector height_pt,
+                      RObject gp, RObject name) {
+  typedef SEXP (*Fun)(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+  static Fun fun = gridtext_callable<Fun>("rect_grob");
+  return gridtext_check_result(fun(x_pt, y_pt, width_pt, height_pt, gp, name));
+}
+
+inline List rect_grob_vectorized(NumericVector x_pt, NumericVector y_pt, NumericVector width_pt,
+                                 NumericVector height_pt, RObject gp, RObject name) {
+  typedef SEXP (*Fun)(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+  static Fun fun = gridtext_callable<Fun>("rect_grob_vectorized");
+  return gridtext_check_result(fun(x_pt, y_pt, width_pt, height_pt, gp, name));
+}
+
+inline List roundrect_grob(NumericVector x_pt, NumericVector y_pt, NumericVector width_pt, NumericVector height_pt,
+                           NumericVector r_pt, RObject gp, RObject name) {
+  typedef SEXP (*Fun)(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+  static Fun fun = gridtext_callable<Fun>("roundrect_grob");
+  return gridtext_check_result(fun(x_pt, y_pt, width_pt, height_pt, r_pt, gp, name));
+}
+
+#endif
+
+#endif
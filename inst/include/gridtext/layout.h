@@ -1,5 +1,5 @@
-#ifndef LAYOUT_H
-#define LAYOUT_H
+#ifndef GRIDTEXT_LAYOUT_H
+#define GRIDTEXT_LAYOUT_H
 
 #include <Rcpp.h>
 using namespace Rcpp;
@@ -56,6 +56,24 @@ public:
   // a height to render into, though boxes may ignore these
   virtual void calc_layout(Length width_hint = 0, Length height_hint = 0) = 0;
 
+  // Height budget for layout. Boxes holding a sequence of other boxes stop breaking
+  // and placing their content once its height exceeds the budget, and boxes wrapping
+  // other boxes pass the budget on to their content. A negative budget means no limit.
+  virtual void set_height_budget(Length) {}
+  // did the content overflow the height budget during the last layout?
+  virtual bool overflow() { return false; }
+  // index of the first node that wasn't placed because of overflow
+  virtual size_t first_unplaced() { return 0; }
+
+  // Scale factor for all font sizes, used when fitting text into a box. At a scale
+  // of 1, text is measured during layout as usual; at any other scale, boxes reuse
+  // their most recent measurements, scaled linearly. Boxes holding other boxes pass
+  // the scale on to them.
+  virtual void set_font_scale(double) {}
+  // width of the widest content, which may be larger than width() if some content
+  // doesn't fit
+  virtual Length content_width() { return width(); }
+
   // place box in internal coordinates used in enclosing box
   virtual void place(Length x, Length y) = 0;
 
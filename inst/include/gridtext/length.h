@@ -0,0 +1,128 @@
+#ifndef GRIDTEXT_LENGTH_H
+#define GRIDTEXT_LENGTH_H
+
+// All lengths are given in pt. By default, Length is simply a double.
+//
+// If GRIDTEXT_SCALED_POINTS is defined at compile time (e.g., via PKG_CPPFLAGS in
+// src/Makevars), Length instead stores an integer number of scaled points (sp),
+// 1/65536 pt, as in TeX. Sums and differences of lengths are then exact, so that
+// the results of layout don't depend on the order of additions, the compiler, or
+// the machine, and lengths can be compared for equality. Lengths still convert
+// implicitly to and from double, in pt; values are rounded to the nearest sp on
+// conversion, and after scaling by a double. The largest representable length is
+// about 1.4e14 pt. Code compiled against gridtext's headers, e.g. by other packages,
+// needs to use the same setting as gridtext itself.
+
+#ifdef GRIDTEXT_SCALED_POINTS
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+class Length {
+  int64_t m_sp;
+
+  // converts a value in sp to an integer, rounding to nearest and saturating
+  // at the representable range; NaN becomes 0
+  static int64_t round_sp(double sp) {
+    if (sp >= 9.2e18) {
+      return std::numeric_limits<int64_t>::max();
+    } else if (sp <= -9.2e18) {
+      return std::numeric_limits<int64_t>::min();
+    } else if (std::isnan(sp)) {
+      return 0;
+    }
+    return static_cast<int64_t>(std::llround(sp));
+  }
+
+public:
+  static constexpr double sp_per_pt = 65536;
+
+  Length() : m_sp(0) {}
+  Length(double pt) : m_sp(round_sp(pt * sp_per_pt)) {}
+
+  static Length from_sp(int64_t sp) {
+    Length l;
+    l.m_sp = sp;
+    return l;
+  }
+
+  int64_t sp() const { return m_sp; }
+  operator double() const { return m_sp / sp_per_pt; }
+
+  Length operator-() const { return from_sp(-m_sp); }
+  Length &operator+=(Length l) { m_sp += l.m_sp; return *this; }
+  Length &operator-=(Length l) { m_sp -= l.m_sp; return *this; }
+  Length &operator*=(double x) { m_sp = round_sp(m_sp * x); return *this; }
+  Length &operator/=(double x) { m_sp = round_sp(m_sp / x); return *this; }
+};
+
+// Arithmetic and comparisons between lengths are exact. Other arithmetic values
+// are interpreted as lengths in pt when added or subtracted, and as factors when
+// multiplying or dividing. Products and ratios of lengths are doubles. The templates
+// make sure these overloads are chosen over the built-in operators for doubles,
+// which would otherwise be ambiguous.
+
+#define GRIDTEXT_LENGTH_ARITHMETIC \
+  template <class T, class = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+
+inline Length operator+(Length a, Length b) { return a += b; }
+inline Length operator-(Length a, Length b) { return a -= b; }
+inline double operator/(Length a, Length b) { return static_cast<double>(a.sp()) / b.sp(); }
+
+GRIDTEXT_LENGTH_ARITHMETIC inline Length operator+(Length a, T b) { return a += Length(b); }
+GRIDTEXT_LENGTH_ARITHMETIC inline Length operator+(T a, Length b) { return b += Length(a); }
+GRIDTEXT_LENGTH_ARITHMETIC inline Length operator-(Length a, T b) { return a -= Length(b); }
+GRIDTEXT_LENGTH_ARITHMETIC inline Length operator-(T a, Length b) { return Length(a) - b; }
+GRIDTEXT_LENGTH_ARITHMETIC inline Length operator*(Length a, T x) { return a *= x; }
+GRIDTEXT_LENGTH_ARITHMETIC inline Length operator*(T x, Length a) { return a *= x; }
+GRIDTEXT_LENGTH_ARITHMETIC inline Length operator/(Length a, T x) { return a /= x; }
+GRIDTEXT_LENGTH_ARITHMETIC inline double operator/(T x, Length a) { return x / static_cast<double>(a); }
+GRIDTEXT_LENGTH_ARITHMETIC inline Length &operator+=(Length &a, T b) { return a += Length(b); }
+GRIDTEXT_LENGTH_ARITHMETIC inline Length &operator-=(Length &a, T b) { return a -= Length(b); }
+
+inline bool operator==(Length a, Length b) { return a.sp() == b.sp(); }
+inline bool operator!=(Length a, Length b) { return a.sp() != b.sp(); }
+inline bool operator<(Length a, Length b) { return a.sp() < b.sp(); }
+inline bool operator<=(Length a, Length b) { return a.sp() <= b.sp(); }
+inline bool operator>(Length a, Length b) { return a.sp() > b.sp(); }
+inline bool operator>=(Length a, Length b) { return a.sp() >= b.sp(); }
+
+// comparisons with other values are done in pt, without rounding the other value
+GRIDTEXT_LENGTH_ARITHMETIC inline bool operator==(Length a, T b) { return static_cast<double>(a) == b; }
+GRIDTEXT_LENGTH_ARITHMETIC inline bool operator!=(Length a, T b) { return static_cast<double>(a) != b; }
+GRIDTEXT_LENGTH_ARITHMETIC inline bool operator<(Length a, T b) { return static_cast<double>(a) < b; }
+GRIDTEXT_LENGTH_ARITHMETIC inline bool operator<=(Length a, T b) { return static_cast<double>(a) <= b; }
+GRIDTEXT_LENGTH_ARITHMETIC inline bool operator>(Length a, T b) { return static_cast<double>(a) > b; }
+GRIDTEXT_LENGTH_ARITHMETIC inline bool operator>=(Length a, T b) { return static_cast<double>(a) >= b; }
+GRIDTEXT_LENGTH_ARITHMETIC inline bool operator==(T a, Length b) { return a == static_cast<double>(b); }
+GRIDTEXT_LENGTH_ARITHMETIC inline bool operator!=(T a, Length b) { return a != static_cast<double>(b); }
+GRIDTEXT_LENGTH_ARITHMETIC inline bool operator<(T a, Length b) { return a < static_cast<double>(b); }
+GRIDTEXT_LENGTH_ARITHMETIC inline bool operator<=(T a, Length b) { return a <= static_cast<double>(b); }
+GRIDTEXT_LENGTH_ARITHMETIC inline bool operator>(T a, Length b) { return a > static_cast<double>(b); }
+GRIDTEXT_LENGTH_ARITHMETIC inline bool operator>=(T a, Length b) { return a >= static_cast<double>(b); }
+
+#undef GRIDTEXT_LENGTH_ARITHMETIC
+
+// Does material of width `width` fit into a line of length `available`? With
+// exact arithmetic, material that fills the line exactly fits.
+inline bool fits_within(Length width, Length available) {
+  return width <= available;
+}
+
+#else
+
+typedef double Length;
+
+// Does material of width `width` fit into a line of length `available`? Widths
+// are sums of many measurements, so material that appears to fill the line
+// exactly may be slightly too wide, and only material that is strictly shorter
+// is considered to fit.
+inline bool fits_within(Length width, Length available) {
+  return width < available;
+}
+
+#endif
+
+#endif
@@ -1,5 +1,5 @@
-#ifndef LINE_BREAKER_H
-#define LINE_BREAKER_H
+#ifndef GRIDTEXT_LINE_BREAKER_H
+#define GRIDTEXT_LINE_BREAKER_H
 
 #include <Rcpp.h>
 using namespace Rcpp;
@@ -34,6 +34,13 @@ private:
   const vector<Length> &m_line_lengths;
   bool m_word_wrap; // do we break at any feasible position or only at forced positions?
   vector<Length> m_sum_widths;
+  size_t m_next_start; // starting point of the next line
+  size_t m_line;       // next line to be processed
+  // if `true`, nodes are laid out only once line breaking reaches them, using
+  // the width and height hints provided; otherwise, they need to be laid out
+  // before line breaking
+  bool m_layout_nodes;
+  Length m_width_hint, m_height_hint;
 
   // get width of node i
   Length get_width(size_t i) {
@@ -54,8 +61,21 @@ private:
     }
   }
 
+  // extend the sums of widths up to point b, laying out nodes along the way
+  // if requested
+  void extend_sum_widths(size_t b) {
+    while (m_sum_widths.size() <= b) {
+      size_t i = m_sum_widths.size() - 1;
+      if (m_layout_nodes && i < m_nodes.size()) {
+        m_nodes[i]->calc_layout(m_width_hint, m_height_hint);
+      }
+      m_sum_widths.push_back(m_sum_widths.back() + get_width(i));
+    }
+  }
+
   // measure width from point a to point b, excluding b
   Length measure_width(size_t a, size_t b) {
+    extend_sum_widths(b);
     return m_sum_widths[b] - m_sum_widths[a];
   }
 
@@ -157,31 +177,50 @@ private:
 
 public:
   LineBreaker(const BoxList<Renderer>& nodes, const vector<Length> &line_lengths,
-              bool word_wrap = true) :
-    m_nodes(nodes), m_line_lengths(line_lengths), m_word_wrap(word_wrap) {
-
-    // calculate sums of widths
-    size_t m = m_nodes.size();
-    m_sum_widths.resize(m + 1);
-    Length running_sum_w = 0;
-    for (size_t i = 0; i < m + 1; i++) {
-      m_sum_widths[i] = running_sum_w;
-      running_sum_w += get_width(i);
+              bool word_wrap = true, bool layout_nodes = false,
+              Length width_hint = 0, Length height_hint = 0) :
+    m_nodes(nodes), m_line_lengths(line_lengths), m_word_wrap(word_wrap),
+    m_next_start(0), m_line(0),
+    m_layout_nodes(layout_nodes), m_width_hint(width_hint), m_height_hint(height_hint) {
+
+    // calculate sums of widths; when nodes are laid out during line breaking,
+    // the sums are calculated as needed
+    m_sum_widths.push_back(0);
+    if (!m_layout_nodes) {
+      extend_sum_widths(m_nodes.size());
     }
   }
 
+  // total width of all nodes before point i
+  Length sum_width(size_t i) {
+    extend_sum_widths(i);
+    return m_sum_widths[i];
+  }
+
+  // index of the first node that hasn't been assigned to a line yet; equals the
+  // number of nodes if all have been assigned
+  size_t next_start() {
+    return find_next_startpoint(m_next_start);
+  }
 
   void compute_line_breaks(vector<LineBreakInfo> &line_breaks) {
     line_breaks.clear(); // this is how we return the results; hence, clear first
+    m_next_start = 0;
+    m_line = 0;
+
+    while (add_next_line(line_breaks)) {}
+  }
 
-    size_t a = 0; // starting point of the current line
-    size_t line = 0; // current line we are processing
-    while (a < m_nodes.size()) {
+  // breaks the next line and appends it to line_breaks; returns false if there
+  // was nothing left to break
+  bool add_next_line(vector<LineBreakInfo> &line_breaks) {
+    size_t a = m_next_start; // starting point of the current line
+    if (a < m_nodes.size()) {
       //cout << "start" << " " << a << " " << m_nodes.size() << endl;
       a = find_next_startpoint(a); // skip whitespace at beginning of line
       size_t b = find_next_feasible_breakpoint(a);
       Length width = measure_width(a, b); // calculate width from a to b, excluding b
-      Length linelen = line_length(line);
+      Length linelen = line_length(m_line);
 
       // at a minimum, the current line contains material from a to b; however, if
       // b is not a forced break and the next piece fits, we can add it
@@ -192,7 +231,7 @@ public:
         Length width_delta = measure_width(b, b_new);
 
         // does the next piece fit?
-        if (width + width_delta < linelen) {
+        if (fits_within(width + width_delta, linelen)) {
           // yes, continue
           width += width_delta;
           b = b_new;
@@ -205,19 +244,21 @@ public:
       // but place only if we're not past the end of the nodes list
       if (a < m_nodes.size()) {
         line_breaks.emplace_back(a, b, 0, width);
-        //cout << line << " " << a << " " << b << endl;
-        line++;
+        //cout << m_line << " " << a << " " << b << endl;
+        m_line++;
 
         // if b is a forced break, we need to advance by 1 to make sure
         // the break penalty gets skipped in the next line
         if (is_forced_break(b)) {
           b++;
         }
-        a = b;
-      } else {
-        break; // exit outer loop, we're done
+        m_next_start = b;
+        return true;
       }
     }
+    // we're done
+    m_next_start = m_nodes.size();
+    return false;
   }
 };
 
@@ -1,5 +1,5 @@
-#ifndef NULL_BOX_H
-#define NULL_BOX_H
+#ifndef GRIDTEXT_NULL_BOX_H
+#define GRIDTEXT_NULL_BOX_H
 
 #include <Rcpp.h>
 using namespace Rcpp;
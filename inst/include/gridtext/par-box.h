@@ -0,0 +1,372 @@
+#ifndef GRIDTEXT_PAR_BOX_H
+#define GRIDTEXT_PAR_BOX_H
+
+#include <Rcpp.h>
+using namespace Rcpp;
+
+#include <iostream>
+
+#include "grid.h"
+#include "layout.h"
+//#include "glue.h"
+//#include "penalty.h"
+#include "line-breaker.h"
+#include "profiler.h"
+
+
+/* The ParBox class takes a list of boxes and lays them out
+ * horizontally, breaking lines if necessary. The reference point
+ * is the left end point of the baseline of the last line.
+ *
+ * The number of lines can be limited. Content that doesn't fit
+ * is then cut off at the end of the last line, and replaced by an
+ * ellipsis, which can be any list of nodes.
+ */
+
+template <class Renderer>
+class ParBox : public Box<Renderer> {
+private:
+  BoxList<Renderer> m_nodes;
+  Length m_vspacing;
+  Length m_width;
+  Length m_ascent;
+  Length m_descent;
+  Length m_voff;
+  SizePolicy m_width_policy;
+  double m_hjust; // horizontal adjustment; can be used to override text adjustment
+  bool m_use_hjust; // should text adjustment be overridden or not?
+  // vertical shift if paragraph contains more than one line; is used to make sure the
+  // bottom line in the box is used as the box baseline (all lines above are folded
+  // into the ascent)
+  Length m_multiline_shift;
+  // calculated left baseline corner of the box after layouting
+  Length m_x, m_y;
+
+  // extents of each line, in the coordinates in which nodes are placed, used to
+  // skip lines outside the clip rectangle during rendering
+  struct LineExtent {
+    size_t start, end; // nodes in the line
+    Length x0, y0, x1, y1; // lower left and upper right corner
+  };
+  vector<LineExtent> m_lines;
+
+  // height budget for layout; a negative value means there is no limit
+  Length m_height_budget;
+  // did the content overflow the height budget in the last layout?
+  bool m_overflow;
+  // first node that wasn't placed because of overflow
+  size_t m_first_unplaced;
+
+  // maximum number of lines; 0 means there is no limit
+  size_t m_max_lines;
+  // nodes appended to the last line when content is cut off
+  BoxList<Renderer> m_ellipsis;
+  // was content cut off in the last layout?
+  bool m_truncated;
+
+  double m_scale; // font scale
+  Length m_content_width; // width of the widest line
+
+  // Shortens a line that is followed by content that gets cut off, so that the
+  // ellipsis fits at its end. The cut point is found by binary search over the
+  // sums of node widths calculated during line breaking, so nothing is measured
+  // again. Lines are only cut in between words.
+  void truncate_line(LineBreakInfo &line, LineBreaker<Renderer> &lb, Length line_length) {
+    Length ellipsis_width = 0;
+    for (auto i_node = m_ellipsis.begin(); i_node != m_ellipsis.end(); i_node++) {
+      ellipsis_width += (*i_node)->width();
+    }
+
+    // find the last point b for which nodes from start to b plus the ellipsis fit
+    Length start_width = lb.sum_width(line.start);
+    size_t lo = line.start, hi = line.end;
+    while (lo < hi) {
+      size_t mid = (lo + hi + 1) / 2;
+      if (lb.sum_width(mid) - start_width + ellipsis_width <= line_length) {
+        lo = mid;
+      } else {
+        hi = mid - 1;
+      }
+    }
+
+    // move back to the end of a word
+    size_t b = lo;
+    while (b > line.start &&
+           !(m_nodes[b-1]->type() == NodeType::box && (b == m_nodes.size() || m_nodes[b]->type() != NodeType::box))) {
+      b--;
+    }
+
+    line.end = b;
+    line.width = lb.sum_width(b) - start_width + ellipsis_width;
+  }
+
+  // calculate ascent and descent of a line, taking into account vertical offsets
+  void line_extents(const LineBreakInfo &line, Length &ascent, Length &descent) {
+    ascent = 0;
+    descent = 0;
+    for (size_t i = line.start; i != line.end; i++) {
+      auto node = m_nodes[i];
+      Length ascent_new = node->ascent() + node->voff();
+      if (ascent_new > ascent) {
+        ascent = ascent_new;
+      }
+      Length descent_new = node->descent() - node->voff();
+      if (descent_new > descent) {
+        descent = descent_new;
+      }
+    }
+  }
+
+public:
+  ParBox(const BoxList<Renderer>& nodes, Length vspacing, SizePolicy width_policy = SizePolicy::native,
+         double hjust = 0, bool use_hjust = false) :
+    m_nodes(nodes), m_vspacing(vspacing),
+    m_width(0), m_ascent(0), m_descent(0), m_voff(0),
+    m_width_policy(width_policy),
+    m_hjust(hjust), m_use_hjust(use_hjust),
+    m_multiline_shift(0), m_x(0), m_y(0),
+    m_height_budget(-1), m_overflow(false), m_first_unplaced(0),
+    m_max_lines(0), m_truncated(false), m_scale(1), m_content_width(0) {
+  }
+  ~ParBox() {};
+
+  Length width() { return m_width; }
+  Length ascent() { return m_ascent; }
+  Length descent() { return m_descent; }
+  Length voff() { return m_voff; }
+
+  void set_height_budget(Length budget) { m_height_budget = budget; }
+  bool overflow() { return m_overflow; }
+  size_t first_unplaced() { return m_first_unplaced; }
+
+  // limits the paragraph to at most `max_lines` lines (0 means no limit); the nodes
+  // in `ellipsis` are shown at the end of the last line if content is cut off
+  void set_max_lines(size_t max_lines, const BoxList<Renderer> &ellipsis) {
+    m_max_lines = max_lines;
+    m_ellipsis = ellipsis;
+  }
+  bool truncated() { return m_truncated; }
+
+  void set_font_scale(double scale) {
+    m_scale = scale;
+    for (auto i_node = m_nodes.begin(); i_node != m_nodes.end(); i_node++) {
+      (*i_node)->set_font_scale(scale);
+    }
+    for (auto i_node = m_ellipsis.begin(); i_node != m_ellipsis.end(); i_node++) {
+      (*i_node)->set_font_scale(scale);
+    }
+  }
+  Length content_width() { return m_content_width; }
+
+  void calc_layout(Length width_hint, Length height_hint) {
+    // we propagate width and height hints to all child nodes,
+    // in case they are useful there
+    Length node_width_hint = width_hint;
+    // line spacing scales with the font size
+    Length vspacing = m_scale * m_vspacing;
+
+    // choose breaking parameters based on size policy
+    bool word_wrap = true;
+    if (m_width_policy == SizePolicy::native) {
+      // for native policy, we don't wrap words and we allow lines to be arbitrarily long
+      word_wrap = false;
+      width_hint = Glue<Renderer>::infinity;
+    }
+
+    // calculate line breaks
+    vector<Length> line_lengths = {width_hint};
+    vector<LineBreakInfo> line_breaks;
+    m_truncated = false;
+    if (m_height_budget < 0 && m_max_lines == 0) {
+      // first make sure all child nodes are in a defined state
+      for (auto i_node = m_nodes.begin(); i_node != m_nodes.end(); i_node++) {
+        (*i_node)->calc_layout(node_width_hint, height_hint);
+      }
+
+      GRIDTEXT_PROFILE(line_breaking);
+      LineBreaker<Renderer> lb(m_nodes, line_lengths, word_wrap);
+      lb.compute_line_breaks(line_breaks);
+      m_overflow = false;
+      m_first_unplaced = m_nodes.size();
+    } else {
+      // with a height budget or a maximum number of lines, lines are broken one at a
+      // time, until the height of the paragraph exceeds the budget or there are no
+      // more lines left; child nodes are laid out only once line breaking reaches
+      // them, so nodes past that point are never touched
+      GRIDTEXT_PROFILE(line_breaking);
+      LineBreaker<Renderer> lb(m_nodes, line_lengths, word_wrap, true, node_width_hint, height_hint);
+      Length y_off = 0, first_ascent = 0, descent = 0;
+      bool budget_exceeded = false;
+      while (lb.add_next_line(line_breaks)) {
+        Length ascent, descent_new;
+        line_extents(line_breaks.back(), ascent, descent_new);
+        // this mirrors the vertical placement of lines below
+        if (line_breaks.size() == 1) {
+          first_ascent = ascent;
+        } else if (ascent + descent > vspacing) {
+          y_off -= ascent + descent;
+        } else {
+          y_off -= vspacing;
+        }
+        descent = descent_new;
+
+        if (m_height_budget >= 0 && first_ascent - y_off + descent > m_height_budget) {
+          budget_exceeded = true;
+          break;
+        }
+        if (m_max_lines > 0 && line_breaks.size() >= m_max_lines) {
+          break;
+        }
+      }
+      m_first_unplaced = lb.next_start();
+      bool more = m_first_unplaced < m_nodes.size();
+
+      if (more && m_max_lines > 0 && line_breaks.size() >= m_max_lines) {
+        for (auto i_node = m_ellipsis.begin(); i_node != m_ellipsis.end(); i_node++) {
+          (*i_node)->calc_layout(node_width_hint, height_hint);
+        }
+        truncate_line(line_breaks.back(), lb, width_hint);
+        m_truncated = true;
+        m_first_unplaced = line_breaks.back().end;
+      }
+
+      m_overflow = more && budget_exceeded;
+      if (!m_overflow) {
+        m_first_unplaced = m_nodes.size();
+      }
+    }
+
+    // find the longest line; this is the true line length for native size policy
+    m_content_width = 0;
+    for (auto i_line = line_breaks.begin(); i_line != line_breaks.end(); i_line++) {
+      if (m_content_width < i_line->width) {
+        m_content_width = i_line->width;
+      }
+    }
+    if (m_width_policy == SizePolicy::native) {
+      width_hint = m_content_width;
+    }
+
+    // now place all nodes according to line breaks
+    Length x_off = 0, y_off = 0; // x and y offset as we layout
+
+    int lines = 0;
+    Length first_ascent = 0; // ascent of the first line
+    Length descent = 0;
+    m_lines.clear();
+
+    for (auto i_line = line_breaks.begin(); i_line != line_breaks.end(); i_line++) {
+      // is this the last line of a truncated paragraph?
+      bool ellipsis = m_truncated && i_line + 1 == line_breaks.end();
+
+      // reset x_off for new line, potentially overriding alignment
+      if (m_use_hjust) {
+        x_off = m_hjust*(width_hint - i_line->width);
+      } else {
+        x_off = 0;
+      }
+
+      // we first get the ascent of each box in the line, to make sure there is
+      // vertical space if some boxes are very tall
+      Length ascent = 0;
+      for (size_t i = i_line->start; i != i_line->end; i++) {
+        auto node = m_nodes[i];
+        Length ascent_new = node->ascent() + node->voff();
+        if (ascent_new > ascent) {
+          ascent = ascent_new;
+        }
+      }
+      if (ellipsis) {
+        for (auto i_node = m_ellipsis.begin(); i_node != m_ellipsis.end(); i_node++) {
+          Length ascent_new = (*i_node)->ascent() + (*i_node)->voff();
+          if (ascent_new > ascent) {
+            ascent = ascent_new;
+          }
+        }
+      }
+      if (lines == 0) { // are we rendering the first line?
+        // yes, record ascent for first line
+        first_ascent = ascent;
+      } else {
+        // no, adjust y_offset as needed
+        if (ascent + descent > vspacing) {
+          y_off = y_off - (ascent + descent);
+        } else {
+          y_off = y_off - vspacing;
+        }
+      }
+
+      // reset descent for new line
+      descent = 0;
+
+      // now loop over all boxes in each line and place
+      Length x_start = x_off;
+      for (size_t i = i_line->start; i != i_line->end; i++) {
+        auto node = m_nodes[i];
+        node->place(x_off, y_off);
+        x_off += node->width();
+
+        // record new descent
+        Length descent_new = node->descent() - node->voff();
+        if (descent_new > descent) {
+          descent = descent_new;
+        }
+      }
+      if (ellipsis) {
+        for (auto i_node = m_ellipsis.begin(); i_node != m_ellipsis.end(); i_node++) {
+          auto node = *i_node;
+          node->place(x_off, y_off);
+          x_off += node->width();
+
+          Length descent_new = node->descent() - node->voff();
+          if (descent_new > descent) {
+            descent = descent_new;
+          }
+        }
+      }
+      m_lines.push_back({i_line->start, i_line->end, x_start, y_off - descent, x_off, y_off + ascent});
+
+      // advance line
+      lines += 1;
+    }
+
+    if (lines > 0) { // at least one line?
+      m_multiline_shift = -1 * y_off; // multi-line boxes need to be shifted upwards
+      m_ascent = first_ascent - y_off;
+      m_descent = descent;
+      m_width = width_hint;
+    } else {
+      m_multiline_shift = 0;
+      m_ascent = 0;
+      m_descent = 0;
+      m_width = width_hint;
+    }
+  }
+
+  void place(Length x, Length y) {
+    m_x = x;
+    m_y = y;
+  }
+
+  void render(Renderer &r, Length xref, Length yref) {
+    Length x = xref + m_x;
+    Length y = yref + m_voff + m_y + m_multiline_shift;
+
+    // render line by line, skipping lines that lie outside the clip rectangle
+    for (auto i_line = m_lines.begin(); i_line != m_lines.end(); i_line++) {
+      if (r.is_clipped(x + i_line->x0, y + i_line->y0, x + i_line->x1, y + i_line->y1)) {
+        continue;
+      }
+      for (size_t i = i_line->start; i != i_line->end; i++) {
+        m_nodes[i]->render(r, x, y);
+      }
+      if (m_truncated && i_line + 1 == m_lines.end()) {
+        for (auto i_node = m_ellipsis.begin(); i_node != m_ellipsis.end(); i_node++) {
+          (*i_node)->render(r, x, y);
+        }
+      }
+    }
+  }
+};
+
+#endif
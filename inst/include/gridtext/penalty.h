@@ -1,5 +1,5 @@
-#ifndef PENALTY_H
-#define PENALTY_H
+#ifndef GRIDTEXT_PENALTY_H
+#define GRIDTEXT_PENALTY_H
 
 #include <Rcpp.h>
 using namespace Rcpp;
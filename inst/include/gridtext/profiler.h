@@ -0,0 +1,65 @@
+#ifndef GRIDTEXT_PROFILER_H
+#define GRIDTEXT_PROFILER_H
+
+// Opt-in timing of the phases of the text pipeline. Profiling is enabled with
+// `options(gridtext.profile = TRUE)`, and results are retrieved with gridtext_profile()
+// and gridtext_profile_trace() in R. The phases in R (markdown conversion, html parsing,
+// and box building) are timed from R; all others are timed here, with the macro
+// GRIDTEXT_PROFILE(phase), which times the remainder of the enclosing scope.
+//
+// Phases can nest, e.g., text is measured during placement; each phase accumulates
+// both its total time and its self time, which excludes the time spent in nested phases.
+// The profiler is part of gridtext itself; in code compiled by other packages, the
+// macro does nothing.
+
+// the order needs to match `profile_phases` in R/profile.R
+enum class ProfilePhase {
+  markdown = 0,
+  html_parse,
+  process_tags,
+  text_measurement,
+  line_breaking,
+  placement,
+  rendering,
+  units
+};
+
+const int profile_phase_count = 8;
+
+#ifdef GRIDTEXT_INTERNAL
+
+// Starts timing a phase, if profiling is enabled. Whether it is enabled is looked up
+// only when no other phase is active, so nested phases are cheap to time. Returns
+// `true` if timing was started, in which case profiler_exit() must be called.
+// Defined in src/profiler.cpp.
+bool profiler_enter(ProfilePhase phase);
+// stops timing the innermost active phase
+void profiler_exit();
+
+class ProfileScope {
+  bool m_active;
+
+public:
+  ProfileScope(ProfilePhase phase) : m_active(profiler_enter(phase)) {}
+  ~ProfileScope() {
+    if (m_active) {
+      profiler_exit();
+    }
+  }
+
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+};
+
+#define GRIDTEXT_PROFILE_CONCAT2(a, b) a##b
+#define GRIDTEXT_PROFILE_CONCAT(a, b) GRIDTEXT_PROFILE_CONCAT2(a, b)
+#define GRIDTEXT_PROFILE(phase) \
+  ProfileScope GRIDTEXT_PROFILE_CONCAT(profile_scope_, __LINE__)(ProfilePhase::phase)
+
+#else
+
+#define GRIDTEXT_PROFILE(phase)
+
+#endif
+
+#endif
@@ -1,5 +1,5 @@
-#ifndef RASTER_BOX_H
-#define RASTER_BOX_H
+#ifndef GRIDTEXT_RASTER_BOX_H
+#define GRIDTEXT_RASTER_BOX_H
 
 #include <Rcpp.h>
 using namespace Rcpp;
@@ -7,13 +7,23 @@ using namespace Rcpp;
 #include <utility> // for pair<>
 using namespace std;
 
+#include "grid.h"
 #include "layout.h"
 
 pair<double, double> image_dimensions(RObject image) {
-  Environment env = Environment::namespace_env("base");
-  Function dim = env["dim"];
+  // lazy images carry their dimensions with them
+  if (image.inherits("gridtext_lazy_image")) {
+    List lazy(image);
+    return pair<double, double>(as<double>(lazy["width"]), as<double>(lazy["height"]));
+  }
+
+  // read the dim attribute directly rather than calling base::dim()
+  RObject dims_obj = image.attr("dim");
+  if (dims_obj.isNULL()) {
+    stop("Cannot extract image dimensions. Image must be a matrix, raster, or nativeRaster object.");
+  }
 
-  NumericVector dims = dim(image);
+  NumericVector dims(dims_obj);
   if (dims.size() < 2) {
     stop("Cannot extract image dimensions. Image must be a matrix, raster, or nativeRaster object.");
   }
@@ -22,14 +32,23 @@ pair<double, double> image_dimensions(RObject image) {
   return pair<double, double>(dims[1], dims[0]);
 }
 
+// decodes a lazy image, by calling its `decode()` function, and converts it to a raster
+RObject decode_lazy_image(RObject image) {
+  List lazy(image);
+  Function decode(lazy["decode"]);
+  return as_raster(decode());
+}
+
 
 // A box holding a single image
 template <class Renderer>
 class RasterBox : public Box<Renderer> {
 private:
   RObject m_image;
+  bool m_lazy; // if `true`, m_image is a lazy image that needs to be decoded before rendering
   typename Renderer::GraphicsContext m_gp;
   Length m_width, m_height;
+  Length m_fixed_width, m_fixed_height; // width and height as specified, for fixed size policy
   SizePolicy m_width_policy, m_height_policy;
   // position of the box in enclosing box
   // the box reference point is the leftmost point of the baseline.
@@ -39,18 +58,28 @@ private:
   double m_dpi; // dots per inch to determine native image sizes
   double m_rel_width, m_rel_height; // used to store relative width and height when needed
   Length m_native_width, m_native_height; // native width and height of image, in pt
+  double m_scale; // font scale; images shrink and grow along with the text around them
 
 public:
   RasterBox(RObject image, Length width, Length height, const typename Renderer::GraphicsContext &gp,
             SizePolicy width_policy = SizePolicy::native, SizePolicy height_policy = SizePolicy::native,
             bool respect_aspect = true, bool interpolate = true, double dpi = 150) :
-    m_image(image), m_gp(gp), m_width(width), m_height(height),
+    m_gp(gp), m_width(width), m_height(height), m_fixed_width(width), m_fixed_height(height),
     m_width_policy(width_policy), m_height_policy(height_policy),
     m_x(0), m_y(0), m_respect_asp(respect_aspect), m_interpolate(interpolate),
     m_dpi(dpi), m_rel_width(0), m_rel_height(0),
-    m_native_width(0), m_native_height(0) {
+    m_native_width(0), m_native_height(0), m_scale(1) {
     pair<double, double> d = image_dimensions(image);
 
+    // convert the image to a raster once, so rendering doesn't have to do it again;
+    // lazy images are only decoded once they are actually rendered
+    m_lazy = image.inherits("gridtext_lazy_image");
+    if (m_lazy) {
+      m_image = image;
+    } else {
+      m_image = as_raster(image);
+    }
+
     // there are 72.27 pt in each in
     m_native_width = d.first * 72.27 / m_dpi;
     m_native_height = d.second * 72.27 / m_dpi;
@@ -69,10 +98,14 @@ public:
   Length descent() { return 0; }
   Length voff() { return 0; }
 
+  void set_font_scale(double scale) { m_scale = scale; }
+
+  // native, relative, and fixed sizes are scaled with the font scale, so that images
+  // take part in shrinking text to fit its box; expanding sizes fill the space given
   void calc_layout(Length width_hint, Length height_hint) {
     if (m_width_policy == SizePolicy::native && m_height_policy == SizePolicy::native) {
-      m_width = m_native_width;
-      m_height = m_native_height;
+      m_width = m_scale * m_native_width;
+      m_height = m_scale * m_native_height;
       return;
     }
 
@@ -81,10 +114,11 @@ public:
       m_width = width_hint;
       break;
     case SizePolicy::relative:
-      m_width = width_hint * m_rel_width;
+      m_width = m_scale * width_hint * m_rel_width;
       break;
     case SizePolicy::fixed:
     default:
+      m_width = m_scale * m_fixed_width;
       break;
     }
 
@@ -93,13 +127,14 @@ public:
       m_height = height_hint;
       break;
     case SizePolicy::relative:
-      m_height = height_hint * m_rel_height;
+      m_height = m_scale * height_hint * m_rel_height;
       break;
     case SizePolicy::native:
       m_height = m_width * m_native_height / m_native_width;
       break;
     case SizePolicy::fixed:
     default:
+      m_height = m_scale * m_fixed_height;
       break;
     }
 
@@ -121,6 +156,11 @@ public:
     Length x = m_x + xref;
     Length y = m_y + yref;
 
+    if (m_lazy) {
+      m_image = decode_lazy_image(m_image);
+      m_lazy = false;
+    }
+
     // adjust for aspect ratio if necessary
     if (!m_respect_asp || (m_width/m_height == m_native_width/m_native_height)) {
       r.raster(m_image, x, y, m_width, m_height, m_interpolate, m_gp);
@@ -1,5 +1,5 @@
-#ifndef RECT_BOX_H
-#define RECT_BOX_H
+#ifndef GRIDTEXT_RECT_BOX_H
+#define GRIDTEXT_RECT_BOX_H
 
 #include <Rcpp.h>
 using namespace Rcpp;
@@ -28,6 +28,13 @@ private:
   // the box reference point is the leftmost point of the baseline.
   Length m_x, m_y;
   double m_rel_width, m_rel_height; // used to store relative width and height when needed
+  bool m_reuse_content_layout; // content has been laid out already and only needs to be placed
+
+  void layout_content(Length width_hint, Length height_hint) {
+    if (!m_reuse_content_layout) {
+      m_content->calc_layout(width_hint, height_hint);
+    }
+  }
 
   // layout calculation when width is defined (doesn't depend on content box)
   void calc_layout_defined_width(Length width_hint, Length height_hint) {
@@ -54,7 +61,7 @@ private:
       } else {
         Length content_width_hint = m_width - m_margin.left - m_margin.right - m_padding.left - m_padding.right;
         Length content_height_hint = height_hint - m_margin.top - m_margin.bottom - m_padding.top - m_padding.bottom;
-        m_content->calc_layout(content_width_hint, content_height_hint);
+        layout_content(content_width_hint, content_height_hint);
         m_height = m_content->height() + m_margin.top + m_margin.bottom + m_padding.top + m_padding.bottom;
       }
     } else {
@@ -76,7 +83,7 @@ private:
       if (m_content) {
         Length content_width_hint = m_width - m_margin.left - m_margin.right - m_padding.left - m_padding.right;
         Length content_height_hint = m_height - m_margin.top - m_margin.bottom - m_padding.top - m_padding.bottom;
-        m_content->calc_layout(content_width_hint, content_height_hint);
+        layout_content(content_width_hint, content_height_hint);
       }
     }
   }
@@ -93,7 +100,7 @@ private:
       } else {
         Length content_width_hint = width_hint - m_margin.left - m_margin.right - m_padding.left - m_padding.right;
         Length content_height_hint = height_hint - m_margin.top - m_margin.bottom - m_padding.top - m_padding.bottom;
-        m_content->calc_layout(content_width_hint, content_height_hint);
+        layout_content(content_width_hint, content_height_hint);
         m_width = m_content->width() + m_margin.left + m_margin.right + m_padding.left + m_padding.right;
         m_height = m_content->height() + m_margin.top + m_margin.bottom + m_padding.top + m_padding.bottom;
       }
@@ -119,7 +126,7 @@ private:
       } else {
         Length content_width_hint = width_hint - m_margin.left - m_margin.right - m_padding.left - m_padding.right;
         Length content_height_hint = m_height - m_margin.top - m_margin.bottom - m_padding.top - m_padding.bottom;
-        m_content->calc_layout(content_width_hint, content_height_hint);
+        layout_content(content_width_hint, content_height_hint);
         m_width = m_content->width() + m_margin.left + m_margin.right + m_padding.left + m_padding.right;
       }
     }
@@ -138,7 +145,7 @@ public:
     m_content(content), m_width(width), m_height(height), m_margin(margin), m_padding(padding),
     m_gp(gp), m_content_hjust(content_hjust), m_content_vjust(content_vjust),
     m_width_policy(width_policy), m_height_policy(height_policy),
-    m_r(r), m_x(0), m_y(0), m_rel_width(0), m_rel_height(0) {
+    m_r(r), m_x(0), m_y(0), m_rel_width(0), m_rel_height(0), m_reuse_content_layout(false) {
     // save relative width and height if needed
     if (m_width_policy == SizePolicy::relative) {
       m_rel_width = m_width/100;
@@ -179,6 +186,54 @@ public:
     }
   }
 
+  // Content that doesn't depend on the size of the box, such as text laid out at
+  // its native size, can be laid out once up front, e.g. to measure it. With
+  // reuse set, the box keeps that layout and merely places the content.
+  void set_reuse_content_layout(bool reuse) {
+    m_reuse_content_layout = reuse;
+  }
+
+  // the height budget applies to the content, minus the space taken up by margin and padding
+  void set_height_budget(Length budget) {
+    if (m_content) {
+      if (budget >= 0) {
+        budget = budget - m_margin.top - m_margin.bottom - m_padding.top - m_padding.bottom;
+        if (budget < 0) {
+          budget = 0;
+        }
+      }
+      m_content->set_height_budget(budget);
+    }
+  }
+  bool overflow() {
+    if (!m_content) {
+      return false;
+    }
+    return m_content->overflow();
+  }
+  size_t first_unplaced() {
+    if (!m_content) {
+      return 0;
+    }
+    return m_content->first_unplaced();
+  }
+
+  void set_font_scale(double scale) {
+    if (m_content) {
+      m_content->set_font_scale(scale);
+    }
+  }
+
+  // content that doesn't fit makes the box wider than its set width
+  Length content_width() {
+    if (!m_content) {
+      return m_width;
+    }
+    Length width = m_content->content_width() +
+      m_margin.left + m_margin.right + m_padding.left + m_padding.right;
+    return width > m_width ? width : m_width;
+  }
+
   // place box in internal coordinates used in enclosing box
   void place(Length x, Length y) {
     m_x = x;
@@ -1,5 +1,5 @@
-#ifndef TEXT_BOX_H
-#define TEXT_BOX_H
+#ifndef GRIDTEXT_TEXT_BOX_H
+#define GRIDTEXT_TEXT_BOX_H
 
 #include <Rcpp.h>
 using namespace Rcpp;
@@ -16,6 +16,9 @@ private:
   Length m_ascent;
   Length m_descent;
   Length m_voff;
+  double m_scale;   // font scale
+  TextDetails m_td; // text measurements at the original font size
+  bool m_measured;
   // position of the box in enclosing box, modulo vertical offset (voff),
   // which gets added to m_y;
   // the box reference point is the leftmost point of the baseline.
@@ -24,20 +27,27 @@ private:
 public:
   TextBox(const CharacterVector &label, const typename Renderer::GraphicsContext &gp, Length voff = 0) :
     m_label(label), m_gp(gp), m_width(0), m_ascent(0), m_descent(0), m_voff(voff),
-    m_x(0), m_y(0) {}
+    m_scale(1), m_measured(false), m_x(0), m_y(0) {}
   ~TextBox() {}
 
   Length width() { return m_width; }
   Length ascent() { return m_ascent; }
   Length descent() { return m_descent; }
-  Length voff() { return m_voff; }
+  Length voff() { return m_scale * m_voff; }
+
+  void set_font_scale(double scale) { m_scale = scale; }
 
   // width and height are only defined once `calc_layout()` has been called
   void calc_layout(Length, Length) {
-    TextDetails td = Renderer::text_details(m_label, m_gp);
-    m_width = td.width;
-    m_ascent = td.ascent;
-    m_descent = td.descent;
+    // at a scaled font size, text widths and heights scale linearly, and we don't
+    // need to measure again
+    if (m_scale == 1 || !m_measured) {
+      m_td = Renderer::text_details(m_label, m_gp);
+      m_measured = true;
+    }
+    m_width = m_scale * m_td.width;
+    m_ascent = m_scale * m_td.ascent;
+    m_descent = m_scale * m_td.descent;
   }
 
   // place box in internal coordinates used in enclosing box
@@ -50,7 +60,7 @@ public:
   // from the enclosing box
   void render(Renderer &r, Length xref, Length yref) {
     Length x = m_x + xref;
-    Length y = m_y + m_voff + yref;
+    Length y = m_y + voff() + yref;
 
     r.text(m_label, x, y, m_gp);
   }
@@ -1,9 +1,13 @@
-#ifndef VBOX_H
-#define VBOX_H
+#ifndef GRIDTEXT_VBOX_H
+#define GRIDTEXT_VBOX_H
 
 #include <Rcpp.h>
 using namespace Rcpp;
 
+#include <vector>
+#include <utility>
+using namespace std;
+
 #include "layout.h"
 
 /* The VBox class takes a list of boxes and lays them out
@@ -24,6 +28,18 @@ private:
   Length m_hjust, m_vjust;
   double m_rel_width; // used to store relative width when needed
 
+  // vertical extents of each node, measured from the top of the box, used to
+  // skip nodes outside the clip rectangle during rendering
+  vector<pair<Length, Length>> m_extents;
+
+  // height budget for layout; a negative value means there is no limit
+  Length m_height_budget;
+  // did the content overflow the height budget in the last layout?
+  bool m_overflow;
+  // first node that wasn't (fully) placed because of overflow
+  size_t m_first_unplaced;
+  Length m_content_width; // width of the widest content of any node
+
 public:
   VBox(const BoxList<Renderer>& nodes, Length width = 0, double hjust = 0, double vjust = 1,
        SizePolicy width_policy = SizePolicy::native) :
@@ -32,7 +48,8 @@ public:
     m_width_policy(width_policy),
     m_x(0), m_y(0),
     m_hjust(hjust), m_vjust(vjust),
-    m_rel_width(0) {
+    m_rel_width(0),
+    m_height_budget(-1), m_overflow(false), m_first_unplaced(0), m_content_width(0) {
     if (m_width_policy == SizePolicy::relative) {
       m_rel_width = m_width/100;
     }
@@ -44,6 +61,17 @@ public:
   Length descent() { return 0; }
   Length voff() { return 0; }
 
+  void set_height_budget(Length budget) { m_height_budget = budget; }
+  bool overflow() { return m_overflow; }
+  size_t first_unplaced() { return m_first_unplaced; }
+
+  void set_font_scale(double scale) {
+    for (auto i_node = m_nodes.begin(); i_node != m_nodes.end(); i_node++) {
+      (*i_node)->set_font_scale(scale);
+    }
+  }
+  Length content_width() { return m_content_width; }
+
   void calc_layout(Length width_hint, Length height_hint) {
     switch(m_width_policy) {
     case SizePolicy::expand:
@@ -66,22 +94,49 @@ public:
     Length y_off = 0;
     // calculated box width
     Length width = 0;
+    m_extents.clear();
+    m_overflow = false;
+    m_first_unplaced = m_nodes.size();
+    m_content_width = 0;
 
-    for (auto i_node = m_nodes.begin(); i_node != m_nodes.end(); i_node++) {
-      auto b = (*i_node);
+    for (size_t i = 0; i < m_nodes.size(); i++) {
+      auto b = m_nodes[i];
+      // child nodes get whatever is left of the height budget
+      if (m_height_budget < 0) {
+        b->set_height_budget(-1);
+      } else {
+        b->set_height_budget(m_height_budget + y_off);
+      }
       // we propagate width and height hints to all child nodes,
       // in case they are useful there
       b->calc_layout(width_hint, height_hint);
+      Length y_top = y_off;
       y_off -= b->ascent();
       // place node, ignoring any vertical offset from baseline
       // (we stack boxes vertically, baselines don't matter here)
       b->place(0, y_off - b->voff());
       y_off -= b->descent(); // account for box descent if any
+      m_extents.emplace_back(y_off, y_top);
 
       // record width
       if (b->width() > width) {
         width = b->width();
       }
+      if (b->content_width() > m_content_width) {
+        m_content_width = b->content_width();
+      }
+
+      // stop once we have exceeded the height budget
+      if (b->overflow()) {
+        m_overflow = true;
+        m_first_unplaced = i;
+        break;
+      }
+      if (m_height_budget >= 0 && -y_off > m_height_budget && i + 1 < m_nodes.size()) {
+        m_overflow = true;
+        m_first_unplaced = i + 1;
+        break;
+      }
     }
 
     if (m_width_policy == SizePolicy::native) {
@@ -98,13 +153,17 @@ public:
   }
 
   void render(Renderer &r, Length xref, Length yref) {
-    // render all grobs in the list
-    for (auto i_node = m_nodes.begin(); i_node != m_nodes.end(); i_node++) {
-      (*i_node)->render(
-            r,
-            xref + m_x - m_hjust*m_width,
-            yref + m_height + m_y - m_vjust*m_height
-      );
+    Length x = xref + m_x - m_hjust*m_width;
+    Length y = yref + m_height + m_y - m_vjust*m_height;
+
+    // render all grobs that have been placed, skipping nodes that lie outside
+    // the clip rectangle
+    for (size_t i = 0; i < m_extents.size(); i++) {
+      auto b = m_nodes[i];
+      if (r.is_clipped(x, y + m_extents[i].first, x + b->width(), y + m_extents[i].second)) {
+        continue;
+      }
+      b->render(r, x, y);
     }
   }
 };
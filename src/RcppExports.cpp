@@ -19,8 +19,8 @@ BEGIN_RCPP
 END_RCPP
 }
 // bl_make_par_box
-BoxPtr<GridRenderer> bl_make_par_box(const List& node_list, double vspacing_pt, String width_policy, RObject hjust);
-RcppExport SEXP _gridtext_bl_make_par_box(SEXP node_listSEXP, SEXP vspacing_ptSEXP, SEXP width_policySEXP, SEXP hjustSEXP) {
+BoxPtr<GridRenderer> bl_make_par_box(const List& node_list, double vspacing_pt, String width_policy, RObject hjust, int max_lines, RObject ellipsis);
+RcppExport SEXP _gridtext_bl_make_par_box(SEXP node_listSEXP, SEXP vspacing_ptSEXP, SEXP width_policySEXP, SEXP hjustSEXP, SEXP max_linesSEXP, SEXP ellipsisSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -28,7 +28,9 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< double >::type vspacing_pt(vspacing_ptSEXP);
     Rcpp::traits::input_parameter< String >::type width_policy(width_policySEXP);
     Rcpp::traits::input_parameter< RObject >::type hjust(hjustSEXP);
-    rcpp_result_gen = Rcpp::wrap(bl_make_par_box(node_list, vspacing_pt, width_policy, hjust));
+    Rcpp::traits::input_parameter< int >::type max_lines(max_linesSEXP);
+    Rcpp::traits::input_parameter< RObject >::type ellipsis(ellipsisSEXP);
+    rcpp_result_gen = Rcpp::wrap(bl_make_par_box(node_list, vspacing_pt, width_policy, hjust, max_lines, ellipsis));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -133,6 +135,28 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// bl_needs_restore
+bool bl_needs_restore(RObject node);
+RcppExport SEXP _gridtext_bl_needs_restore(SEXP nodeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< RObject >::type node(nodeSEXP);
+    rcpp_result_gen = Rcpp::wrap(bl_needs_restore(node));
+    return rcpp_result_gen;
+END_RCPP
+}
+// bl_adopt_node
+void bl_adopt_node(RObject node, RObject from);
+RcppExport SEXP _gridtext_bl_adopt_node(SEXP nodeSEXP, SEXP fromSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< RObject >::type node(nodeSEXP);
+    Rcpp::traits::input_parameter< RObject >::type from(fromSEXP);
+    bl_adopt_node(node, from);
+    return R_NilValue;
+END_RCPP
+}
 // bl_box_width
 double bl_box_width(BoxPtr<GridRenderer> node);
 RcppExport SEXP _gridtext_bl_box_width(SEXP nodeSEXP) {
@@ -189,17 +213,67 @@ BEGIN_RCPP
 END_RCPP
 }
 // bl_calc_layout
-void bl_calc_layout(BoxPtr<GridRenderer> node, double width_pt, double height_pt);
-RcppExport SEXP _gridtext_bl_calc_layout(SEXP nodeSEXP, SEXP width_ptSEXP, SEXP height_ptSEXP) {
+void bl_calc_layout(BoxPtr<GridRenderer> node, double width_pt, double height_pt, RObject height_budget_pt);
+RcppExport SEXP _gridtext_bl_calc_layout(SEXP nodeSEXP, SEXP width_ptSEXP, SEXP height_ptSEXP, SEXP height_budget_ptSEXP) {
 BEGIN_RCPP
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< BoxPtr<GridRenderer> >::type node(nodeSEXP);
     Rcpp::traits::input_parameter< double >::type width_pt(width_ptSEXP);
     Rcpp::traits::input_parameter< double >::type height_pt(height_ptSEXP);
-    bl_calc_layout(node, width_pt, height_pt);
+    Rcpp::traits::input_parameter< RObject >::type height_budget_pt(height_budget_ptSEXP);
+    bl_calc_layout(node, width_pt, height_pt, height_budget_pt);
     return R_NilValue;
 END_RCPP
 }
+// bl_set_font_scale
+void bl_set_font_scale(BoxPtr<GridRenderer> node, double scale);
+RcppExport SEXP _gridtext_bl_set_font_scale(SEXP nodeSEXP, SEXP scaleSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< BoxPtr<GridRenderer> >::type node(nodeSEXP);
+    Rcpp::traits::input_parameter< double >::type scale(scaleSEXP);
+    bl_set_font_scale(node, scale);
+    return R_NilValue;
+END_RCPP
+}
+// bl_fit_font_scale
+double bl_fit_font_scale(BoxPtr<GridRenderer> node, double width_pt, double max_width_pt, double max_height_pt, double min_scale, int iterations);
+RcppExport SEXP _gridtext_bl_fit_font_scale(SEXP nodeSEXP, SEXP width_ptSEXP, SEXP max_width_ptSEXP, SEXP max_height_ptSEXP, SEXP min_scaleSEXP, SEXP iterationsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< BoxPtr<GridRenderer> >::type node(nodeSEXP);
+    Rcpp::traits::input_parameter< double >::type width_pt(width_ptSEXP);
+    Rcpp::traits::input_parameter< double >::type max_width_pt(max_width_ptSEXP);
+    Rcpp::traits::input_parameter< double >::type max_height_pt(max_height_ptSEXP);
+    Rcpp::traits::input_parameter< double >::type min_scale(min_scaleSEXP);
+    Rcpp::traits::input_parameter< int >::type iterations(iterationsSEXP);
+    rcpp_result_gen = Rcpp::wrap(bl_fit_font_scale(node, width_pt, max_width_pt, max_height_pt, min_scale, iterations));
+    return rcpp_result_gen;
+END_RCPP
+}
+// bl_box_overflow
+bool bl_box_overflow(BoxPtr<GridRenderer> node);
+RcppExport SEXP _gridtext_bl_box_overflow(SEXP nodeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< BoxPtr<GridRenderer> >::type node(nodeSEXP);
+    rcpp_result_gen = Rcpp::wrap(bl_box_overflow(node));
+    return rcpp_result_gen;
+END_RCPP
+}
+// bl_box_first_unplaced
+int bl_box_first_unplaced(BoxPtr<GridRenderer> node);
+RcppExport SEXP _gridtext_bl_box_first_unplaced(SEXP nodeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< BoxPtr<GridRenderer> >::type node(nodeSEXP);
+    rcpp_result_gen = Rcpp::wrap(bl_box_first_unplaced(node));
+    return rcpp_result_gen;
+END_RCPP
+}
 // bl_place
 void bl_place(BoxPtr<GridRenderer> node, double x_pt, double y_pt);
 RcppExport SEXP _gridtext_bl_place(SEXP nodeSEXP, SEXP x_ptSEXP, SEXP y_ptSEXP) {
@@ -213,25 +287,100 @@ BEGIN_RCPP
 END_RCPP
 }
 // bl_render
-RObject bl_render(BoxPtr<GridRenderer> node, double x_pt, double y_pt);
-RcppExport SEXP _gridtext_bl_render(SEXP nodeSEXP, SEXP x_ptSEXP, SEXP y_ptSEXP) {
+RObject bl_render(BoxPtr<GridRenderer> node, double x_pt, double y_pt, bool coalesce_text, bool batch_rects, double raster_dpi, RObject clip);
+RcppExport SEXP _gridtext_bl_render(SEXP nodeSEXP, SEXP x_ptSEXP, SEXP y_ptSEXP, SEXP coalesce_textSEXP, SEXP batch_rectsSEXP, SEXP raster_dpiSEXP, SEXP clipSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< BoxPtr<GridRenderer> >::type node(nodeSEXP);
     Rcpp::traits::input_parameter< double >::type x_pt(x_ptSEXP);
     Rcpp::traits::input_parameter< double >::type y_pt(y_ptSEXP);
-    rcpp_result_gen = Rcpp::wrap(bl_render(node, x_pt, y_pt));
+    Rcpp::traits::input_parameter< bool >::type coalesce_text(coalesce_textSEXP);
+    Rcpp::traits::input_parameter< bool >::type batch_rects(batch_rectsSEXP);
+    Rcpp::traits::input_parameter< double >::type raster_dpi(raster_dpiSEXP);
+    Rcpp::traits::input_parameter< RObject >::type clip(clipSEXP);
+    rcpp_result_gen = Rcpp::wrap(bl_render(node, x_pt, y_pt, coalesce_text, batch_rects, raster_dpi, clip));
+    return rcpp_result_gen;
+END_RCPP
+}
+// bl_draw
+void bl_draw(BoxPtr<GridRenderer> node, NumericMatrix transform, double rotation, List gp, double x_pt, double y_pt, double raster_dpi);
+RcppExport SEXP _gridtext_bl_draw(SEXP nodeSEXP, SEXP transformSEXP, SEXP rotationSEXP, SEXP gpSEXP, SEXP x_ptSEXP, SEXP y_ptSEXP, SEXP raster_dpiSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< BoxPtr<GridRenderer> >::type node(nodeSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type transform(transformSEXP);
+    Rcpp::traits::input_parameter< double >::type rotation(rotationSEXP);
+    Rcpp::traits::input_parameter< List >::type gp(gpSEXP);
+    Rcpp::traits::input_parameter< double >::type x_pt(x_ptSEXP);
+    Rcpp::traits::input_parameter< double >::type y_pt(y_ptSEXP);
+    Rcpp::traits::input_parameter< double >::type raster_dpi(raster_dpiSEXP);
+    bl_draw(node, transform, rotation, gp, x_pt, y_pt, raster_dpi);
+    return R_NilValue;
+END_RCPP
+}
+// bl_render_svg
+String bl_render_svg(BoxPtr<GridRenderer> node, double raster_dpi);
+RcppExport SEXP _gridtext_bl_render_svg(SEXP nodeSEXP, SEXP raster_dpiSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< BoxPtr<GridRenderer> >::type node(nodeSEXP);
+    Rcpp::traits::input_parameter< double >::type raster_dpi(raster_dpiSEXP);
+    rcpp_result_gen = Rcpp::wrap(bl_render_svg(node, raster_dpi));
+    return rcpp_result_gen;
+END_RCPP
+}
+// bl_render_display_list
+List bl_render_display_list(BoxPtr<GridRenderer> node, double x_pt, double y_pt);
+RcppExport SEXP _gridtext_bl_render_display_list(SEXP nodeSEXP, SEXP x_ptSEXP, SEXP y_ptSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< BoxPtr<GridRenderer> >::type node(nodeSEXP);
+    Rcpp::traits::input_parameter< double >::type x_pt(x_ptSEXP);
+    Rcpp::traits::input_parameter< double >::type y_pt(y_ptSEXP);
+    rcpp_result_gen = Rcpp::wrap(bl_render_display_list(node, x_pt, y_pt));
+    return rcpp_result_gen;
+END_RCPP
+}
+// bl_make_label_grobs
+List bl_make_label_grobs(const List& inner_boxes, const IntegerVector& index, const List& x, const List& y, NumericVector rot, NumericVector halign, NumericVector valign, NumericVector hjust, NumericVector vjust, NumericVector margin, NumericVector padding, NumericVector r, const List& box_gp, bool align_widths, bool align_heights, bool direct, double raster_dpi);
+RcppExport SEXP _gridtext_bl_make_label_grobs(SEXP inner_boxesSEXP, SEXP indexSEXP, SEXP xSEXP, SEXP ySEXP, SEXP rotSEXP, SEXP halignSEXP, SEXP valignSEXP, SEXP hjustSEXP, SEXP vjustSEXP, SEXP marginSEXP, SEXP paddingSEXP, SEXP rSEXP, SEXP box_gpSEXP, SEXP align_widthsSEXP, SEXP align_heightsSEXP, SEXP directSEXP, SEXP raster_dpiSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const List& >::type inner_boxes(inner_boxesSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type index(indexSEXP);
+    Rcpp::traits::input_parameter< const List& >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const List& >::type y(ySEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type rot(rotSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type halign(halignSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type valign(valignSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type hjust(hjustSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type vjust(vjustSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type margin(marginSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type padding(paddingSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type r(rSEXP);
+    Rcpp::traits::input_parameter< const List& >::type box_gp(box_gpSEXP);
+    Rcpp::traits::input_parameter< bool >::type align_widths(align_widthsSEXP);
+    Rcpp::traits::input_parameter< bool >::type align_heights(align_heightsSEXP);
+    Rcpp::traits::input_parameter< bool >::type direct(directSEXP);
+    Rcpp::traits::input_parameter< double >::type raster_dpi(raster_dpiSEXP);
+    rcpp_result_gen = Rcpp::wrap(bl_make_label_grobs(inner_boxes, index, x, y, rot, halign, valign, hjust, vjust, margin, padding, r, box_gp, align_widths, align_heights, direct, raster_dpi));
     return rcpp_result_gen;
 END_RCPP
 }
 // grid_renderer
-XPtr<GridRenderer> grid_renderer();
-RcppExport SEXP _gridtext_grid_renderer() {
+XPtr<GridRenderer> grid_renderer(bool coalesce_text, bool batch_rects, double raster_dpi);
+RcppExport SEXP _gridtext_grid_renderer(SEXP coalesce_textSEXP, SEXP batch_rectsSEXP, SEXP raster_dpiSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    rcpp_result_gen = Rcpp::wrap(grid_renderer());
+    Rcpp::traits::input_parameter< bool >::type coalesce_text(coalesce_textSEXP);
+    Rcpp::traits::input_parameter< bool >::type batch_rects(batch_rectsSEXP);
+    Rcpp::traits::input_parameter< double >::type raster_dpi(raster_dpiSEXP);
+    rcpp_result_gen = Rcpp::wrap(grid_renderer(coalesce_text, batch_rects, raster_dpi));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -340,6 +489,74 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// text_grob_vectorized
+List text_grob_vectorized(CharacterVector label, NumericVector x_pt, NumericVector y_pt, RObject gp, RObject name);
+RcppExport SEXP _gridtext_text_grob_vectorized(SEXP labelSEXP, SEXP x_ptSEXP, SEXP y_ptSEXP, SEXP gpSEXP, SEXP nameSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< CharacterVector >::type label(labelSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type x_pt(x_ptSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type y_pt(y_ptSEXP);
+    Rcpp::traits::input_parameter< RObject >::type gp(gpSEXP);
+    Rcpp::traits::input_parameter< RObject >::type name(nameSEXP);
+    rcpp_result_gen = Rcpp::wrap(text_grob_vectorized(label, x_pt, y_pt, gp, name));
+    return rcpp_result_gen;
+END_RCPP
+}
+// as_raster
+RObject as_raster(RObject image);
+RcppExport SEXP _gridtext_as_raster(SEXP imageSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< RObject >::type image(imageSEXP);
+    rcpp_result_gen = Rcpp::wrap(as_raster(image));
+    return rcpp_result_gen;
+END_RCPP
+}
+// downsample_cache_bytes
+double downsample_cache_bytes();
+RcppExport SEXP _gridtext_downsample_cache_bytes() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(downsample_cache_bytes());
+    return rcpp_result_gen;
+END_RCPP
+}
+// downsample_cache_trim
+void downsample_cache_trim(double max_bytes);
+RcppExport SEXP _gridtext_downsample_cache_trim(SEXP max_bytesSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< double >::type max_bytes(max_bytesSEXP);
+    downsample_cache_trim(max_bytes);
+    return R_NilValue;
+END_RCPP
+}
+// downsample_cache_clear
+void downsample_cache_clear();
+RcppExport SEXP _gridtext_downsample_cache_clear() {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    downsample_cache_clear();
+    return R_NilValue;
+END_RCPP
+}
+// downsample_raster
+RObject downsample_raster(RObject image, int width_px, int height_px);
+RcppExport SEXP _gridtext_downsample_raster(SEXP imageSEXP, SEXP width_pxSEXP, SEXP height_pxSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< RObject >::type image(imageSEXP);
+    Rcpp::traits::input_parameter< int >::type width_px(width_pxSEXP);
+    Rcpp::traits::input_parameter< int >::type height_px(height_pxSEXP);
+    rcpp_result_gen = Rcpp::wrap(downsample_raster(image, width_px, height_px));
+    return rcpp_result_gen;
+END_RCPP
+}
 // raster_grob
 List raster_grob(RObject image, NumericVector x_pt, NumericVector y_pt, NumericVector width_pt, NumericVector height_pt, LogicalVector interpolate, RObject gp, RObject name);
 RcppExport SEXP _gridtext_raster_grob(SEXP imageSEXP, SEXP x_ptSEXP, SEXP y_ptSEXP, SEXP width_ptSEXP, SEXP height_ptSEXP, SEXP interpolateSEXP, SEXP gpSEXP, SEXP nameSEXP) {
@@ -374,6 +591,22 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// rect_grob_vectorized
+List rect_grob_vectorized(NumericVector x_pt, NumericVector y_pt, NumericVector width_pt, NumericVector height_pt, RObject gp, RObject name);
+RcppExport SEXP _gridtext_rect_grob_vectorized(SEXP x_ptSEXP, SEXP y_ptSEXP, SEXP width_ptSEXP, SEXP height_ptSEXP, SEXP gpSEXP, SEXP nameSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type x_pt(x_ptSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type y_pt(y_ptSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type width_pt(width_ptSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type height_pt(height_ptSEXP);
+    Rcpp::traits::input_parameter< RObject >::type gp(gpSEXP);
+    Rcpp::traits::input_parameter< RObject >::type name(nameSEXP);
+    rcpp_result_gen = Rcpp::wrap(rect_grob_vectorized(x_pt, y_pt, width_pt, height_pt, gp, name));
+    return rcpp_result_gen;
+END_RCPP
+}
 // roundrect_grob
 List roundrect_grob(NumericVector x_pt, NumericVector y_pt, NumericVector width_pt, NumericVector height_pt, NumericVector r_pt, RObject gp, RObject name);
 RcppExport SEXP _gridtext_roundrect_grob(SEXP x_ptSEXP, SEXP y_ptSEXP, SEXP width_ptSEXP, SEXP height_ptSEXP, SEXP r_ptSEXP, SEXP gpSEXP, SEXP nameSEXP) {
@@ -391,6 +624,20 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// viewport_ll
+List viewport_ll(RObject x, RObject y, double angle, RObject name);
+RcppExport SEXP _gridtext_viewport_ll(SEXP xSEXP, SEXP ySEXP, SEXP angleSEXP, SEXP nameSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< RObject >::type x(xSEXP);
+    Rcpp::traits::input_parameter< RObject >::type y(ySEXP);
+    Rcpp::traits::input_parameter< double >::type angle(angleSEXP);
+    Rcpp::traits::input_parameter< RObject >::type name(nameSEXP);
+    rcpp_result_gen = Rcpp::wrap(viewport_ll(x, y, angle, name));
+    return rcpp_result_gen;
+END_RCPP
+}
 // set_grob_coords
 RObject set_grob_coords(RObject grob, NumericVector x, NumericVector y);
 RcppExport SEXP _gridtext_set_grob_coords(SEXP grobSEXP, SEXP xSEXP, SEXP ySEXP) {
@@ -404,10 +651,71 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// image_header_size
+RObject image_header_size(RObject source, bool is_png);
+RcppExport SEXP _gridtext_image_header_size(SEXP sourceSEXP, SEXP is_pngSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< RObject >::type source(sourceSEXP);
+    Rcpp::traits::input_parameter< bool >::type is_png(is_pngSEXP);
+    rcpp_result_gen = Rcpp::wrap(image_header_size(source, is_png));
+    return rcpp_result_gen;
+END_RCPP
+}
+// profiler_enter_phase
+bool profiler_enter_phase(int phase);
+RcppExport SEXP _gridtext_profiler_enter_phase(SEXP phaseSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type phase(phaseSEXP);
+    rcpp_result_gen = Rcpp::wrap(profiler_enter_phase(phase));
+    return rcpp_result_gen;
+END_RCPP
+}
+// profiler_exit_phase
+void profiler_exit_phase();
+RcppExport SEXP _gridtext_profiler_exit_phase() {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    profiler_exit_phase();
+    return R_NilValue;
+END_RCPP
+}
+// profiler_reset
+void profiler_reset();
+RcppExport SEXP _gridtext_profiler_reset() {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    profiler_reset();
+    return R_NilValue;
+END_RCPP
+}
+// profiler_summary
+List profiler_summary();
+RcppExport SEXP _gridtext_profiler_summary() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(profiler_summary());
+    return rcpp_result_gen;
+END_RCPP
+}
+// profiler_events
+List profiler_events();
+RcppExport SEXP _gridtext_profiler_events() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(profiler_events());
+    return rcpp_result_gen;
+END_RCPP
+}
 
 static const R_CallMethodDef CallEntries[] = {
     {"_gridtext_bl_make_null_box", (DL_FUNC) &_gridtext_bl_make_null_box, 2},
-    {"_gridtext_bl_make_par_box", (DL_FUNC) &_gridtext_bl_make_par_box, 4},
+    {"_gridtext_bl_make_par_box", (DL_FUNC) &_gridtext_bl_make_par_box, 6},
     {"_gridtext_bl_make_rect_box", (DL_FUNC) &_gridtext_bl_make_rect_box, 11},
     {"_gridtext_bl_make_text_box", (DL_FUNC) &_gridtext_bl_make_text_box, 3},
     {"_gridtext_bl_make_raster_box", (DL_FUNC) &_gridtext_bl_make_raster_box, 9},
@@ -415,15 +723,25 @@ static const R_CallMethodDef CallEntries[] = {
     {"_gridtext_bl_make_regular_space_glue", (DL_FUNC) &_gridtext_bl_make_regular_space_glue, 3},
     {"_gridtext_bl_make_forced_break_penalty", (DL_FUNC) &_gridtext_bl_make_forced_break_penalty, 0},
     {"_gridtext_bl_make_never_break_penalty", (DL_FUNC) &_gridtext_bl_make_never_break_penalty, 0},
+    {"_gridtext_bl_needs_restore", (DL_FUNC) &_gridtext_bl_needs_restore, 1},
+    {"_gridtext_bl_adopt_node", (DL_FUNC) &_gridtext_bl_adopt_node, 2},
     {"_gridtext_bl_box_width", (DL_FUNC) &_gridtext_bl_box_width, 1},
     {"_gridtext_bl_box_height", (DL_FUNC) &_gridtext_bl_box_height, 1},
     {"_gridtext_bl_box_ascent", (DL_FUNC) &_gridtext_bl_box_ascent, 1},
     {"_gridtext_bl_box_descent", (DL_FUNC) &_gridtext_bl_box_descent, 1},
     {"_gridtext_bl_box_voff", (DL_FUNC) &_gridtext_bl_box_voff, 1},
-    {"_gridtext_bl_calc_layout", (DL_FUNC) &_gridtext_bl_calc_layout, 3},
+    {"_gridtext_bl_calc_layout", (DL_FUNC) &_gridtext_bl_calc_layout, 4},
+    {"_gridtext_bl_set_font_scale", (DL_FUNC) &_gridtext_bl_set_font_scale, 2},
+    {"_gridtext_bl_fit_font_scale", (DL_FUNC) &_gridtext_bl_fit_font_scale, 6},
+    {"_gridtext_bl_box_overflow", (DL_FUNC) &_gridtext_bl_box_overflow, 1},
+    {"_gridtext_bl_box_first_unplaced", (DL_FUNC) &_gridtext_bl_box_first_unplaced, 1},
     {"_gridtext_bl_place", (DL_FUNC) &_gridtext_bl_place, 3},
-    {"_gridtext_bl_render", (DL_FUNC) &_gridtext_bl_render, 3},
-    {"_gridtext_grid_renderer", (DL_FUNC) &_gridtext_grid_renderer, 0},
+    {"_gridtext_bl_render", (DL_FUNC) &_gridtext_bl_render, 7},
+    {"_gridtext_bl_draw", (DL_FUNC) &_gridtext_bl_draw, 7},
+    {"_gridtext_bl_render_svg", (DL_FUNC) &_gridtext_bl_render_svg, 2},
+    {"_gridtext_bl_render_display_list", (DL_FUNC) &_gridtext_bl_render_display_list, 3},
+    {"_gridtext_bl_make_label_grobs", (DL_FUNC) &_gridtext_bl_make_label_grobs, 17},
+    {"_gridtext_grid_renderer", (DL_FUNC) &_gridtext_grid_renderer, 3},
     {"_gridtext_grid_renderer_text", (DL_FUNC) &_gridtext_grid_renderer_text, 5},
     {"_gridtext_grid_renderer_text_details", (DL_FUNC) &_gridtext_grid_renderer_text_details, 2},
     {"_gridtext_grid_renderer_raster", (DL_FUNC) &_gridtext_grid_renderer_raster, 7},
@@ -432,14 +750,30 @@ static const R_CallMethodDef CallEntries[] = {
     {"_gridtext_unit_pt", (DL_FUNC) &_gridtext_unit_pt, 1},
     {"_gridtext_gpar_empty", (DL_FUNC) &_gridtext_gpar_empty, 0},
     {"_gridtext_text_grob", (DL_FUNC) &_gridtext_text_grob, 5},
+    {"_gridtext_text_grob_vectorized", (DL_FUNC) &_gridtext_text_grob_vectorized, 5},
+    {"_gridtext_as_raster", (DL_FUNC) &_gridtext_as_raster, 1},
+    {"_gridtext_downsample_cache_bytes", (DL_FUNC) &_gridtext_downsample_cache_bytes, 0},
+    {"_gridtext_downsample_cache_trim", (DL_FUNC) &_gridtext_downsample_cache_trim, 1},
+    {"_gridtext_downsample_cache_clear", (DL_FUNC) &_gridtext_downsample_cache_clear, 0},
+    {"_gridtext_downsample_raster", (DL_FUNC) &_gridtext_downsample_raster, 3},
     {"_gridtext_raster_grob", (DL_FUNC) &_gridtext_raster_grob, 8},
     {"_gridtext_rect_grob", (DL_FUNC) &_gridtext_rect_grob, 6},
+    {"_gridtext_rect_grob_vectorized", (DL_FUNC) &_gridtext_rect_grob_vectorized, 6},
     {"_gridtext_roundrect_grob", (DL_FUNC) &_gridtext_roundrect_grob, 7},
+    {"_gridtext_viewport_ll", (DL_FUNC) &_gridtext_viewport_ll, 4},
     {"_gridtext_set_grob_coords", (DL_FUNC) &_gridtext_set_grob_coords, 3},
+    {"_gridtext_image_header_size", (DL_FUNC) &_gridtext_image_header_size, 2},
+    {"_gridtext_profiler_enter_phase", (DL_FUNC) &_gridtext_profiler_enter_phase, 1},
+    {"_gridtext_profiler_exit_phase", (DL_FUNC) &_gridtext_profiler_exit_phase, 0},
+    {"_gridtext_profiler_reset", (DL_FUNC) &_gridtext_profiler_reset, 0},
+    {"_gridtext_profiler_summary", (DL_FUNC) &_gridtext_profiler_summary, 0},
+    {"_gridtext_profiler_events", (DL_FUNC) &_gridtext_profiler_events, 0},
     {NULL, NULL, 0}
 };
 
+void register_callables(DllInfo* dll);
 RcppExport void R_init_gridtext(DllInfo *dll) {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
+    register_callables(dll);
 }
@@ -1,14 +1,18 @@
 #include <Rcpp.h>
 using namespace Rcpp;
 
-#include "layout.h"
-#include "null-box.h"
-#include "par-box.h"
-#include "raster-box.h"
-#include "rect-box.h"
-#include "text-box.h"
-#include "vbox.h"
-#include "grid-renderer.h"
+#include "gridtext/layout.h"
+#include "gridtext/null-box.h"
+#include "gridtext/par-box.h"
+#include "gridtext/raster-box.h"
+#include "gridtext/rect-box.h"
+#include "gridtext/text-box.h"
+#include "gridtext/vbox.h"
+#include "gridtext/grid-renderer.h"
+#include "gridtext/profiler.h"
+#include "display-list-renderer.h"
+#include "ge-renderer.h"
+#include "svg-renderer.h"
 
 /* Various helper functions (not exported) */
 
@@ -35,6 +39,21 @@ SizePolicy convert_size_policy(String size_policy) {
   }
 }
 
+// Box nodes live in external pointers, which turn into null pointers when they are
+// serialized, e.g. with saveRDS() or when sent to a parallel worker. Grobs holding
+// box trees therefore keep the input the trees were built from, and rebuild them
+// where needed (see restore_textbox_inner() and restore_direct_labels()); nodes
+// are not restored individually.
+bool needs_restore(RObject node) {
+  return TYPEOF(node) == EXTPTRSXP && R_ExternalPtrAddr(node) == nullptr;
+}
+
+void check_not_serialized(RObject node) {
+  if (needs_restore(node)) {
+    stop("Node has been serialized and needs to be rebuilt.");
+  }
+}
+
 BoxList<GridRenderer> make_node_list(const List &nodes) {
   BoxList<GridRenderer> nlist;
   nlist.reserve(nodes.size());
@@ -44,12 +63,21 @@ BoxList<GridRenderer> make_node_list(const List &nodes) {
     if (!obj.inherits("bl_node")) {
       stop("All list elements must be of type 'bl_node'.");
     }
+    check_not_serialized(obj);
     BoxPtr<GridRenderer> p(obj);
     nlist.push_back(p);
   }
   return nlist;
 }
 
+// checks that the node is of type 'bl_node' and usable
+void prepare_node(RObject node) {
+  if (!node.inherits("bl_node")) {
+    stop("Node must be of type 'bl_node'.");
+  }
+  check_not_serialized(node);
+}
+
 /* Exported R bindings */
 
 /*
@@ -68,7 +96,8 @@ BoxPtr<GridRenderer> bl_make_null_box(double width_pt = 0, double height_pt = 0)
 
 // [[Rcpp::export]]
 BoxPtr<GridRenderer> bl_make_par_box(const List &node_list, double vspacing_pt, String width_policy = "native",
-                                     RObject hjust = R_NilValue) {
+                                     RObject hjust = R_NilValue, int max_lines = 0,
+                                     RObject ellipsis = R_NilValue) {
   SizePolicy w_policy = convert_size_policy(width_policy);
 
   double hjust_val = 0;
@@ -81,8 +110,18 @@ BoxPtr<GridRenderer> bl_make_par_box(const List &node_list, double vspacing_pt,
     }
   }
 
+  if (max_lines < 0) {
+    stop("Maximum number of lines must not be negative.");
+  }
+
   BoxList<GridRenderer> nodes(make_node_list(node_list));
-  BoxPtr<GridRenderer> p(new ParBox<GridRenderer>(nodes, vspacing_pt, w_policy, hjust_val, use_hjust));
+  BoxList<GridRenderer> ellipsis_nodes;
+  if (!ellipsis.isNULL()) {
+    ellipsis_nodes = make_node_list(as<List>(ellipsis));
+  }
+  ParBox<GridRenderer> *pb = new ParBox<GridRenderer>(nodes, vspacing_pt, w_policy, hjust_val, use_hjust);
+  pb->set_max_lines(max_lines, ellipsis_nodes);
+  BoxPtr<GridRenderer> p(pb);
 
   StringVector cl = {"bl_par_box", "bl_box", "bl_node"};
   p.attr("class") = cl;
@@ -105,28 +144,22 @@ BoxPtr<GridRenderer> bl_make_rect_box(RObject content, double width_pt, double h
   SizePolicy w_policy = convert_size_policy(width_policy);
   SizePolicy h_policy = convert_size_policy(height_policy);
 
-  StringVector cl = {"bl_rect_box", "bl_box", "bl_node"};
-
-  if (content.isNULL()) {
-    // R doesn't like null pointers, so we have to create
-    // a null box instead
-    BoxPtr<GridRenderer> nb(new NullBox<GridRenderer>(0, 0));
-    BoxPtr<GridRenderer> p(new RectBox<GridRenderer>(
-      nb, width_pt, height_pt, marg, pad, gp,
-      content_hjust, content_vjust, w_policy, h_policy, r
-    ));
+  // R doesn't like null pointers, so we have to create
+  // a null box instead
+  if (!content.isNULL()) {
+    check_not_serialized(content);
+  }
+  BoxPtr<GridRenderer> content_box = content.isNULL() ?
+    BoxPtr<GridRenderer>(new NullBox<GridRenderer>(0, 0)) : as<BoxPtr<GridRenderer>>(content);
+  BoxPtr<GridRenderer> p(new RectBox<GridRenderer>(
+    content_box, width_pt, height_pt, marg, pad, gp,
+    content_hjust, content_vjust, w_policy, h_policy, r
+  ));
 
-    p.attr("class") = cl;
-    return p;
-  } else {
-    BoxPtr<GridRenderer> p(new RectBox<GridRenderer>(
-      as<BoxPtr<GridRenderer>>(content),
-      width_pt, height_pt, marg, pad, gp, content_hjust, content_vjust, w_policy, h_policy, r
-    ));
+  StringVector cl = {"bl_rect_box", "bl_box", "bl_node"};
+  p.attr("class") = cl;
 
-    p.attr("class") = cl;
-    return p;
-  }
+  return p;
 }
 
 // [[Rcpp::export]]
@@ -215,80 +248,422 @@ BoxPtr<GridRenderer> bl_make_never_break_penalty() {
 }
 
 /*
- * Call member functions
+ * Restoring serialized nodes
  */
 
 // [[Rcpp::export]]
-double bl_box_width(BoxPtr<GridRenderer> node) {
+bool bl_needs_restore(RObject node) {
   if (!node.inherits("bl_node")) {
     stop("Node must be of type 'bl_node'.");
   }
 
+  return needs_restore(node);
+}
+
+// Makes the serialized node `node` take over the box held by `from`, a node rebuilt
+// from the same input, so that all references to `node`, e.g. from a grob or from
+// a layout cache, remain valid. `from` is left empty.
+// [[Rcpp::export]]
+void bl_adopt_node(RObject node, RObject from) {
+  if (!node.inherits("bl_node") || !from.inherits("bl_node")) {
+    stop("Nodes must be of type 'bl_node'.");
+  }
+  if (!needs_restore(node)) {
+    stop("Only serialized nodes can be restored.");
+  }
+  check_not_serialized(from);
+
+  R_SetExternalPtrAddr(node, R_ExternalPtrAddr(from));
+  R_ClearExternalPtr(from);
+  R_RegisterCFinalizerEx(
+    node, finalizer_wrapper<BoxNode<GridRenderer>, standard_delete_finalizer<BoxNode<GridRenderer>>>, FALSE
+  );
+}
+
+/*
+ * Call member functions
+ */
+
+// [[Rcpp::export]]
+double bl_box_width(BoxPtr<GridRenderer> node) {
+  prepare_node(node);
+
   return node->width();
 }
 
 // [[Rcpp::export]]
 double bl_box_height(BoxPtr<GridRenderer> node) {
-  if (!node.inherits("bl_node")) {
-    stop("Node must be of type 'bl_node'.");
-  }
+  prepare_node(node);
 
   return node->height();
 }
 
 // [[Rcpp::export]]
 double bl_box_ascent(BoxPtr<GridRenderer> node) {
-  if (!node.inherits("bl_node")) {
-    stop("Node must be of type 'bl_node'.");
-  }
+  prepare_node(node);
 
   return node->ascent();
 }
 
 // [[Rcpp::export]]
 double bl_box_descent(BoxPtr<GridRenderer> node) {
-  if (!node.inherits("bl_node")) {
-    stop("Node must be of type 'bl_node'.");
-  }
+  prepare_node(node);
 
   return node->descent();
 }
 
 // [[Rcpp::export]]
 double bl_box_voff(BoxPtr<GridRenderer> node) {
-  if (!node.inherits("bl_node")) {
-    stop("Node must be of type 'bl_node'.");
-  }
+  prepare_node(node);
 
   return node->voff();
 }
 
 // [[Rcpp::export]]
-void bl_calc_layout(BoxPtr<GridRenderer> node, double width_pt = 0, double height_pt = 0) {
-  if (!node.inherits("bl_node")) {
-    stop("Node must be of type 'bl_node'.");
+void bl_calc_layout(BoxPtr<GridRenderer> node, double width_pt = 0, double height_pt = 0,
+                    RObject height_budget_pt = R_NilValue) {
+  prepare_node(node);
+  GRIDTEXT_PROFILE(placement);
+
+  // a height budget of NULL means no limit
+  double budget = -1;
+  if (!height_budget_pt.isNULL()) {
+    budget = as<double>(height_budget_pt);
+    // NA needs to be caught here, since it cannot be represented by scaled-point lengths
+    if (ISNAN(budget) || budget < 0) {
+      stop("Height budget must not be negative or NA.");
+    }
   }
-
+  node->set_height_budget(budget);
   node->calc_layout(width_pt, height_pt);
 }
 
 // [[Rcpp::export]]
-void bl_place(BoxPtr<GridRenderer> node, double x_pt, double y_pt) {
-  if (!node.inherits("bl_node")) {
-    stop("Node must be of type 'bl_node'.");
+void bl_set_font_scale(BoxPtr<GridRenderer> node, double scale = 1) {
+  prepare_node(node);
+  if (scale <= 0) {
+    stop("Font scale must be positive.");
   }
 
-  node->place(x_pt, y_pt);
+  node->set_font_scale(scale);
 }
 
+// lays out the node at the given font scale and checks whether it fits
+bool fits_at_scale(BoxPtr<GridRenderer> &node, double scale, double width_pt, double max_width_pt,
+                   double max_height_pt) {
+  node->set_font_scale(scale);
+  node->calc_layout(width_pt, 0);
+  // allow for rounding errors
+  return node->content_width() <= max_width_pt + 1e-6 && node->height() <= max_height_pt + 1e-6;
+}
 
+// Finds the largest font scale, between `min_scale` and 1, at which the node
+// fits into the given maximum width and height, by bisection. Text is measured
+// only once, at the original size; at all other scales, widths and heights are
+// scaled from these measurements. The node is left laid out at the scale returned.
 // [[Rcpp::export]]
-RObject bl_render(BoxPtr<GridRenderer> node, double x_pt = 0, double y_pt = 0) {
-  if (!node.inherits("bl_node")) {
-    stop("Node must be of type 'bl_node'.");
+double bl_fit_font_scale(BoxPtr<GridRenderer> node, double width_pt, double max_width_pt,
+                         double max_height_pt, double min_scale = 0.1, int iterations = 10) {
+  prepare_node(node);
+  GRIDTEXT_PROFILE(placement);
+  if (min_scale <= 0 || min_scale > 1) {
+    stop("Minimum font scale must lie between 0 and 1.");
+  }
+
+  node->set_height_budget(-1);
+  if (fits_at_scale(node, 1, width_pt, max_width_pt, max_height_pt)) {
+    return 1;
+  }
+  if (!fits_at_scale(node, min_scale, width_pt, max_width_pt, max_height_pt)) {
+    return min_scale;
+  }
+
+  double lo = min_scale, hi = 1;
+  for (int i = 0; i < iterations; i++) {
+    double mid = (lo + hi) / 2;
+    if (fits_at_scale(node, mid, width_pt, max_width_pt, max_height_pt)) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
   }
 
-  GridRenderer gr;
+  fits_at_scale(node, lo, width_pt, max_width_pt, max_height_pt);
+  return lo;
+}
+
+// [[Rcpp::export]]
+bool bl_box_overflow(BoxPtr<GridRenderer> node) {
+  prepare_node(node);
+
+  return node->overflow();
+}
+
+// [[Rcpp::export]]
+int bl_box_first_unplaced(BoxPtr<GridRenderer> node) {
+  prepare_node(node);
+
+  // indices are 1-based in R
+  return node->first_unplaced() + 1;
+}
+
+// [[Rcpp::export]]
+void bl_place(BoxPtr<GridRenderer> node, double x_pt, double y_pt) {
+  prepare_node(node);
+  GRIDTEXT_PROFILE(placement);
+
+  node->place(x_pt, y_pt);
+}
+
+
+// [[Rcpp::export]]
+RObject bl_render(BoxPtr<GridRenderer> node, double x_pt = 0, double y_pt = 0, bool coalesce_text = false,
+                  bool batch_rects = false, double raster_dpi = 0, RObject clip = R_NilValue) {
+  prepare_node(node);
+  GRIDTEXT_PROFILE(rendering);
+
+  GridRenderer gr(coalesce_text, batch_rects, raster_dpi);
+  if (!clip.isNULL()) {
+    // clip rectangle as (x0, y0, x1, y1), in pt
+    NumericVector c = as<NumericVector>(clip);
+    if (c.size() != 4) {
+      stop("Clip rectangle must be a numeric vector of length 4.");
+    }
+    gr.set_clip(c[0], c[1], c[2], c[3]);
+  }
   node->render(gr, x_pt, y_pt);
   return gr.collect_grobs();
 }
+
+// [[Rcpp::export]]
+void bl_draw(BoxPtr<GridRenderer> node, NumericMatrix transform, double rotation, List gp,
+             double x_pt = 0, double y_pt = 0, double raster_dpi = 0) {
+  prepare_node(node);
+  GRIDTEXT_PROFILE(rendering);
+
+  GraphicsEngineRenderer ger(transform, rotation, gp, raster_dpi);
+  node->render(ger, x_pt, y_pt);
+}
+
+// [[Rcpp::export]]
+String bl_render_svg(BoxPtr<GridRenderer> node, double raster_dpi = 0) {
+  prepare_node(node);
+  GRIDTEXT_PROFILE(rendering);
+
+  // the node's reference point is placed at the lower left corner of the drawing
+  SvgRenderer sr(node->height(), raster_dpi);
+  node->render(sr, 0, 0);
+  return sr.collect_svg(node->width());
+}
+
+// [[Rcpp::export]]
+List bl_render_display_list(BoxPtr<GridRenderer> node, double x_pt = 0, double y_pt = 0) {
+  prepare_node(node);
+  GRIDTEXT_PROFILE(rendering);
+
+  DisplayListRenderer dl;
+  node->render(dl, x_pt, y_pt);
+  return dl.collect();
+}
+
+/*
+ * Vectorized construction of text labels
+ */
+
+// returns element i of v, recycling v as needed
+double recycled(const NumericVector &v, R_xlen_t i) {
+  return v[i % v.size()];
+}
+
+// Lays out and renders a whole vector of text labels, as drawn by richtext_grob(), in one
+// call. Each distinct label consists of an inner box, holding the formatted text, which is
+// placed into a rect box with the given margin, padding, and box_gp. With align_widths
+// and/or align_heights, all rect boxes are made large enough to hold the largest content.
+// Inner boxes are laid out only once, at their native size; the rect boxes merely place them.
+// Labels that differ only in location and rotation share the same inner box; `index` maps
+// each label to its inner box (1-based), and each inner box is laid out and rendered once.
+// The arguments halign, valign, hjust, vjust, r, and box_gp are given per inner box, and
+// x, y, and rot per label.
+// Returns a list holding the child grob of each label, the x and y coordinates of the four
+// corners of each label relative to its reference point, as n x 4 matrices, and the
+// horizontal and vertical extents of each label around its reference point.
+// [[Rcpp::export]]
+List bl_make_label_grobs(const List &inner_boxes, const IntegerVector &index, const List &x, const List &y,
+                         NumericVector rot, NumericVector halign, NumericVector valign, NumericVector hjust,
+                         NumericVector vjust, NumericVector margin, NumericVector padding, NumericVector r,
+                         const List &box_gp, bool align_widths = false, bool align_heights = false,
+                         bool direct = false, double raster_dpi = 0) {
+  R_xlen_t m = inner_boxes.size();
+  R_xlen_t n = index.size();
+  if (halign.size() != m || valign.size() != m || hjust.size() != m || vjust.size() != m ||
+      r.size() != m || box_gp.size() != m) {
+    stop("Alignment, radius, and box_gp arguments must have one element per inner box.");
+  }
+  if (x.size() != n || y.size() != n) {
+    stop("Arguments index, x, and y must have the same length.");
+  }
+  if (n > 0 && rot.size() == 0) {
+    stop("Argument rot must not be empty.");
+  }
+
+  Margin marg = convert_margin(margin);
+  Margin pad = convert_margin(padding);
+
+  // lay out and measure the content of each distinct label
+  BoxList<GridRenderer> contents;
+  contents.reserve(m);
+  Length max_width = 0, max_height = 0;
+  for (R_xlen_t k = 0; k < m; k++) {
+    RObject content = inner_boxes[k];
+    if (!content.inherits("bl_box")) {
+      stop("Contents must be of type 'bl_box'.");
+    }
+    check_not_serialized(content);
+    BoxPtr<GridRenderer> p = as<BoxPtr<GridRenderer>>(content);
+    p->set_height_budget(-1);
+    {
+      GRIDTEXT_PROFILE(placement);
+      p->calc_layout(0, 0);
+    }
+    if (p->width() > max_width) {
+      max_width = p->width();
+    }
+    if (p->height() > max_height) {
+      max_height = p->height();
+    }
+    contents.push_back(p);
+  }
+
+  // aligned boxes need extra space for margin and padding
+  SizePolicy w_policy = SizePolicy::native, h_policy = SizePolicy::native;
+  Length box_width = 0, box_height = 0;
+  if (align_widths) {
+    box_width = max_width + marg.left + marg.right + pad.left + pad.right;
+    w_policy = SizePolicy::fixed;
+  }
+  if (align_heights) {
+    box_height = max_height + marg.top + marg.bottom + pad.top + pad.bottom;
+    h_policy = SizePolicy::fixed;
+  }
+
+  StringVector rect_cl = {"bl_rect_box", "bl_box", "bl_node"};
+  StringVector vbox_cl = {"bl_vbox", "bl_box", "bl_node"};
+  StringVector gtree_cl = {"gTree", "grob", "gDesc"};
+  StringVector direct_cl = {"richtext_direct_grob", "grob", "gDesc"};
+
+  // then, lay out and render each distinct label
+  vector<BoxPtr<GridRenderer>> outer_boxes;
+  outer_boxes.reserve(m);
+  List children(m);
+  GridRenderer gr(true, true, raster_dpi);
+
+  for (R_xlen_t k = 0; k < m; k++) {
+    List gp = box_gp[k];
+    RectBox<GridRenderer> *rb = new RectBox<GridRenderer>(
+      contents[k], box_width, box_height, marg, pad, gp,
+      halign[k], valign[k], w_policy, h_policy, r[k]
+    );
+    rb->set_reuse_content_layout(true);
+    BoxPtr<GridRenderer> rect_box(rb);
+    rect_box.attr("class") = rect_cl;
+
+    BoxPtr<GridRenderer> vbox_outer(new VBox<GridRenderer>(
+      BoxList<GridRenderer>(1, rect_box), 0, hjust[k], vjust[k], SizePolicy::native
+    ));
+    vbox_outer.attr("class") = vbox_cl;
+
+    vbox_outer->set_height_budget(-1);
+    {
+      GRIDTEXT_PROFILE(placement);
+      vbox_outer->calc_layout(0, 0);
+    }
+    outer_boxes.push_back(vbox_outer);
+
+    if (!direct) {
+      GRIDTEXT_PROFILE(rendering);
+      vbox_outer->render(gr, 0, 0);
+      List grobs = gr.collect_grobs();
+
+      // children are referred to by name, as set up by grid::gTree()
+      CharacterVector grob_names(grobs.size());
+      for (R_xlen_t j = 0; j < grobs.size(); j++) {
+        grob_names[j] = as<List>(grobs[j])["name"];
+      }
+      grobs.attr("names") = grob_names;
+      children[k] = grobs;
+    }
+  }
+
+  // finally, place a copy of the appropriate label at each location
+  List grobs(n);
+  NumericMatrix xext(n, 4), yext(n, 4);
+  NumericVector xmin(n), xmax(n), ymin(n), ymax(n);
+  // need to produce a unique name for each grob, otherwise grid gets grumpy
+  static int label_count = 0;
+
+  for (R_xlen_t i = 0; i < n; i++) {
+    R_xlen_t k = index[i] - 1;
+    if (k < 0 || k >= m) {
+      stop("Label index out of range.");
+    }
+    BoxPtr<GridRenderer> &vbox_outer = outer_boxes[k];
+
+    // corner points relative to the reference point, in pt
+    // (lower left, lower right, upper left, upper right before rotation)
+    double theta = recycled(rot, i)*2*M_PI/360;
+    double c = cos(theta), s = sin(theta);
+    double hj = hjust[k], vj = vjust[k];
+    Length w = vbox_outer->width(), h = vbox_outer->height();
+    NumericVector xe(4), ye(4);
+    xe[0] = -hj*c*w + vj*s*h;
+    ye[0] = -hj*s*w - vj*c*h;
+    xe[1] = xe[0] + w*c;
+    ye[1] = ye[0] + w*s;
+    xe[2] = xe[0] - h*s;
+    ye[2] = ye[0] + h*c;
+    xe[3] = xe[2] + w*c;
+    ye[3] = ye[2] + w*s;
+    xmin[i] = xmax[i] = xe[0];
+    ymin[i] = ymax[i] = ye[0];
+    for (int j = 0; j < 4; j++) {
+      xext(i, j) = xe[j];
+      yext(i, j) = ye[j];
+      xmin[i] = min(xmin[i], xe[j]);
+      xmax[i] = max(xmax[i], xe[j]);
+      ymin[i] = min(ymin[i], ye[j]);
+      ymax[i] = max(ymax[i], ye[j]);
+    }
+
+    label_count += 1;
+    string name("gridtext.label.");
+    name = name + to_string(label_count);
+
+    RObject xi = x[i], yi = y[i];
+    List vp = viewport_ll(xi, yi, recycled(rot, i), R_NilValue);
+
+    if (direct) {
+      // the box is drawn at drawing time, by drawDetails.richtext_direct_grob()
+      List out = List::create(
+        _["x"] = xi, _["y"] = yi, _["xext"] = xe, _["yext"] = ye, _["vbox_outer"] = vbox_outer,
+        _["name"] = name, _["gp"] = R_NilValue, _["vp"] = vp
+      );
+      out.attr("class") = direct_cl;
+      grobs[i] = out;
+    } else {
+      List label_children = children[k];
+      RObject children_order = label_children.attr("names");
+      List out = List::create(
+        _["x"] = xi, _["y"] = yi, _["xext"] = xe, _["yext"] = ye,
+        _["name"] = name, _["gp"] = R_NilValue, _["vp"] = vp,
+        _["children"] = label_children, _["childrenOrder"] = children_order
+      );
+      out.attr("class") = gtree_cl;
+      grobs[i] = out;
+    }
+  }
+
+  return List::create(
+    _["grobs"] = grobs, _["xext"] = xext, _["yext"] = yext,
+    _["xmin"] = xmin, _["xmax"] = xmax, _["ymin"] = ymin, _["ymax"] = ymax
+  );
+}
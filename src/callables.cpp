@@ -0,0 +1,240 @@
+/* C-callables, through which the compiled code of other packages can use the
+ * layout engine; see inst/include/gridtext.h. The C-callables take and return
+ * SEXPs and convert their arguments exactly as when called from R. They must
+ * not raise R errors, because the longjmp would skip the destructors in the
+ * calling code. Instead, errors are returned as a character vector of class
+ * "try-error" holding the error message, which the caller turns back into a
+ * C++ exception (see gridtext_check_result() in gridtext/grid.h).
+ *
+ * Two exceptions thrown by Rcpp are not errors and are passed on as such:
+ * a LongjumpException, which carries an R-level jump (e.g., a condition
+ * unwinding the stack) through C++ code, and an InterruptedException, for a
+ * user interrupt. They are returned as a list of class "gridtext_longjump"
+ * holding the jump's token, or as an object of class "gridtext_interrupt", and
+ * the caller throws them again, so that Rcpp resumes the jump or the interrupt
+ * once the exception reaches R.
+ */
+
+#include <Rcpp.h>
+#include <R_ext/Rdynload.h>
+using namespace Rcpp;
+
+#include <exception>
+
+#include "gridtext/grid.h"
+#include "gridtext/layout.h"
+#include "gridtext/grid-renderer.h"
+
+// box constructors, defined in bl-r-bindings.cpp
+BoxPtr<GridRenderer> bl_make_null_box(double width_pt, double height_pt);
+BoxPtr<GridRenderer> bl_make_par_box(const List &node_list, double vspacing_pt, String width_policy,
+                                     RObject hjust, int max_lines, RObject ellipsis);
+BoxPtr<GridRenderer> bl_make_rect_box(RObject content, double width_pt, double height_pt,
+                                      NumericVector margin, NumericVector padding, List gp,
+                                      double content_hjust, double content_vjust, String width_policy,
+                                      String height_policy, double r);
+BoxPtr<GridRenderer> bl_make_text_box(const CharacterVector &label, List gp, double voff_pt);
+BoxPtr<GridRenderer> bl_make_raster_box(RObject image, double width_pt, double height_pt,
+                                        String width_policy, String height_policy,
+                                        bool respect_aspect, bool interpolate, double dpi, List gp);
+BoxPtr<GridRenderer> bl_make_vbox(const List &node_list, double width_pt, double hjust, double vjust,
+                                  String width_policy);
+BoxPtr<GridRenderer> bl_make_regular_space_glue(List gp, double stretch_ratio, double shrink_ratio);
+BoxPtr<GridRenderer> bl_make_forced_break_penalty();
+BoxPtr<GridRenderer> bl_make_never_break_penalty();
+
+SEXP callable_error(const char *message) {
+  CharacterVector out = CharacterVector::create(message);
+  out.attr("class") = "try-error";
+  return out;
+}
+
+SEXP callable_longjump(SEXP token) {
+  List out = List::create(token);
+  out.attr("class") = "gridtext_longjump";
+  return out;
+}
+
+SEXP callable_interrupt() {
+  LogicalVector out(1, true);
+  out.attr("class") = "gridtext_interrupt";
+  return out;
+}
+
+#define BEGIN_CALLABLE try {
+#define END_CALLABLE \
+  } catch (Rcpp::LongjumpException &e) { \
+    return callable_longjump(e.token); \
+  } catch (Rcpp::internal::InterruptedException &e) { \
+    return callable_interrupt(); \
+  } catch (std::exception &e) { \
+    return callable_error(e.what()); \
+  } catch (...) { \
+    return callable_error("C++ exception (unknown reason)"); \
+  }
+
+/* Box construction, see builder.h */
+
+SEXP callable_bl_make_null_box(SEXP width_pt, SEXP height_pt) {
+  BEGIN_CALLABLE
+  return bl_make_null_box(as<double>(width_pt), as<double>(height_pt));
+  END_CALLABLE
+}
+
+SEXP callable_bl_make_par_box(SEXP node_list, SEXP vspacing_pt, SEXP width_policy, SEXP hjust,
+                              SEXP max_lines, SEXP ellipsis) {
+  BEGIN_CALLABLE
+  return bl_make_par_box(
+    as<List>(node_list), as<double>(vspacing_pt), as<String>(width_policy), RObject(hjust),
+    as<int>(max_lines), RObject(ellipsis)
+  );
+  END_CALLABLE
+}
+
+SEXP callable_bl_make_rect_box(SEXP content, SEXP width_pt, SEXP height_pt, SEXP margin, SEXP padding,
+                               SEXP gp, SEXP content_hjust, SEXP content_vjust, SEXP width_policy,
+                               SEXP height_policy, SEXP r) {
+  BEGIN_CALLABLE
+  return bl_make_rect_box(
+    RObject(content), as<double>(width_pt), as<double>(height_pt), as<NumericVector>(margin),
+    as<NumericVector>(padding), as<List>(gp), as<double>(content_hjust), as<double>(content_vjust),
+    as<String>(width_policy), as<String>(height_policy), as<double>(r)
+  );
+  END_CALLABLE
+}
+
+SEXP callable_bl_make_text_box(SEXP label, SEXP gp, SEXP voff_pt) {
+  BEGIN_CALLABLE
+  return bl_make_text_box(as<CharacterVector>(label), as<List>(gp), as<double>(voff_pt));
+  END_CALLABLE
+}
+
+SEXP callable_bl_make_raster_box(SEXP image, SEXP width_pt, SEXP height_pt, SEXP width_policy,
+                                 SEXP height_policy, SEXP respect_aspect, SEXP interpolate, SEXP dpi,
+                                 SEXP gp) {
+  BEGIN_CALLABLE
+  return bl_make_raster_box(
+    RObject(image), as<double>(width_pt), as<double>(height_pt), as<String>(width_policy),
+    as<String>(height_policy), as<bool>(respect_aspect), as<bool>(interpolate), as<double>(dpi),
+    as<List>(gp)
+  );
+  END_CALLABLE
+}
+
+SEXP callable_bl_make_vbox(SEXP node_list, SEXP width_pt, SEXP hjust, SEXP vjust, SEXP width_policy) {
+  BEGIN_CALLABLE
+  return bl_make_vbox(
+    as<List>(node_list), as<double>(width_pt), as<double>(hjust), as<double>(vjust),
+    as<String>(width_policy)
+  );
+  END_CALLABLE
+}
+
+SEXP callable_bl_make_regular_space_glue(SEXP gp, SEXP stretch_ratio, SEXP shrink_ratio) {
+  BEGIN_CALLABLE
+  return bl_make_regular_space_glue(as<List>(gp), as<double>(stretch_ratio), as<double>(shrink_ratio));
+  END_CALLABLE
+}
+
+SEXP callable_bl_make_forced_break_penalty() {
+  BEGIN_CALLABLE
+  return bl_make_forced_break_penalty();
+  END_CALLABLE
+}
+
+SEXP callable_bl_make_never_break_penalty() {
+  BEGIN_CALLABLE
+  return bl_make_never_break_penalty();
+  END_CALLABLE
+}
+
+/* Grob construction, needed by GridRenderer and RasterBox, see grid.h */
+
+SEXP callable_text_grob(SEXP label, SEXP x_pt, SEXP y_pt, SEXP gp, SEXP name) {
+  BEGIN_CALLABLE
+  return text_grob(
+    as<CharacterVector>(label), as<NumericVector>(x_pt), as<NumericVector>(y_pt), RObject(gp), RObject(name)
+  );
+  END_CALLABLE
+}
+
+SEXP callable_text_grob_vectorized(SEXP label, SEXP x_pt, SEXP y_pt, SEXP gp, SEXP name) {
+  BEGIN_CALLABLE
+  return text_grob_vectorized(
+    as<CharacterVector>(label), as<NumericVector>(x_pt), as<NumericVector>(y_pt), RObject(gp), RObject(name)
+  );
+  END_CALLABLE
+}
+
+SEXP callable_as_raster(SEXP image) {
+  BEGIN_CALLABLE
+  return as_raster(RObject(image));
+  END_CALLABLE
+}
+
+SEXP callable_downsample_raster(SEXP image, SEXP width_px, SEXP height_px) {
+  BEGIN_CALLABLE
+  return downsample_raster(RObject(image), as<int>(width_px), as<int>(height_px));
+  END_CALLABLE
+}
+
+SEXP callable_raster_grob(SEXP image, SEXP x_pt, SEXP y_pt, SEXP width_pt, SEXP height_pt,
+                          SEXP interpolate, SEXP gp, SEXP name) {
+  BEGIN_CALLABLE
+  return raster_grob(
+    RObject(image), as<NumericVector>(x_pt), as<NumericVector>(y_pt), as<NumericVector>(width_pt),
+    as<NumericVector>(height_pt), as<LogicalVector>(interpolate), RObject(gp), RObject(name)
+  );
+  END_CALLABLE
+}
+
+SEXP callable_rect_grob(SEXP x_pt, SEXP y_pt, SEXP width_pt, SEXP height_pt, SEXP gp, SEXP name) {
+  BEGIN_CALLABLE
+  return rect_grob(
+    as<NumericVector>(x_pt), as<NumericVector>(y_pt), as<NumericVector>(width_pt),
+    as<NumericVector>(height_pt), RObject(gp), RObject(name)
+  );
+  END_CALLABLE
+}
+
+SEXP callable_rect_grob_vectorized(SEXP x_pt, SEXP y_pt, SEXP width_pt, SEXP height_pt, SEXP gp, SEXP name) {
+  BEGIN_CALLABLE
+  return rect_grob_vectorized(
+    as<NumericVector>(x_pt), as<NumericVector>(y_pt), as<NumericVector>(width_pt),
+    as<NumericVector>(height_pt), RObject(gp), RObject(name)
+  );
+  END_CALLABLE
+}
+
+SEXP callable_roundrect_grob(SEXP x_pt, SEXP y_pt, SEXP width_pt, SEXP height_pt, SEXP r_pt,
+                             SEXP gp, SEXP name) {
+  BEGIN_CALLABLE
+  return roundrect_grob(
+    as<NumericVector>(x_pt), as<NumericVector>(y_pt), as<NumericVector>(width_pt),
+    as<NumericVector>(height_pt), as<NumericVector>(r_pt), RObject(gp), RObject(name)
+  );
+  END_CALLABLE
+}
+
+// called from R_init_gridtext(), when the package is loaded
+// [[Rcpp::init]]
+void register_callables(DllInfo *dll) {
+  R_RegisterCCallable("gridtext", "bl_make_null_box", (DL_FUNC) &callable_bl_make_null_box);
+  R_RegisterCCallable("gridtext", "bl_make_par_box", (DL_FUNC) &callable_bl_make_par_box);
+  R_RegisterCCallable("gridtext", "bl_make_rect_box", (DL_FUNC) &callable_bl_make_rect_box);
+  R_RegisterCCallable("gridtext", "bl_make_text_box", (DL_FUNC) &callable_bl_make_text_box);
+  R_RegisterCCallable("gridtext", "bl_make_raster_box", (DL_FUNC) &callable_bl_make_raster_box);
+  R_RegisterCCallable("gridtext", "bl_make_vbox", (DL_FUNC) &callable_bl_make_vbox);
+  R_RegisterCCallable("gridtext", "bl_make_regular_space_glue", (DL_FUNC) &callable_bl_make_regular_space_glue);
+  R_RegisterCCallable("gridtext", "bl_make_forced_break_penalty", (DL_FUNC) &callable_bl_make_forced_break_penalty);
+  R_RegisterCCallable("gridtext", "bl_make_never_break_penalty", (DL_FUNC) &callable_bl_make_never_break_penalty);
+
+  R_RegisterCCallable("gridtext", "text_grob", (DL_FUNC) &callable_text_grob);
+  R_RegisterCCallable("gridtext", "text_grob_vectorized", (DL_FUNC) &callable_text_grob_vectorized);
+  R_RegisterCCallable("gridtext", "as_raster", (DL_FUNC) &callable_as_raster);
+  R_RegisterCCallable("gridtext", "downsample_raster", (DL_FUNC) &callable_downsample_raster);
+  R_RegisterCCallable("gridtext", "raster_grob", (DL_FUNC) &callable_raster_grob);
+  R_RegisterCCallable("gridtext", "rect_grob", (DL_FUNC) &callable_rect_grob);
+  R_RegisterCCallable("gridtext", "rect_grob_vectorized", (DL_FUNC) &callable_rect_grob_vectorized);
+  R_RegisterCCallable("gridtext", "roundrect_grob", (DL_FUNC) &callable_roundrect_grob);
+}
@@ -0,0 +1,153 @@
+#ifndef DISPLAY_LIST_RENDERER_H
+#define DISPLAY_LIST_RENDERER_H
+
+#include <Rcpp.h>
+using namespace Rcpp;
+
+#include <vector>
+using namespace std;
+
+#include "gridtext/grid-renderer.h"
+#include "gridtext/length.h"
+
+// A renderer that doesn't create any grobs but instead records all drawing
+// primitives into a flat, columnar display list. Since it derives from
+// GridRenderer, it can render the same box trees.
+//
+// Each primitive is recorded with its kind, position, and size, the index of
+// its label (for text) or image (for rasters), and a style handle, the index
+// of its graphics context. Graphics contexts are compared by identity, so all
+// primitives generated from the same drawing context share a style handle.
+class DisplayListRenderer : public GridRenderer {
+public:
+  enum class Kind {
+    text = 1,
+    rect = 2,
+    raster = 3
+  };
+
+private:
+  vector<int> m_kind;
+  vector<Length> m_x, m_y, m_r;
+  // sizes are doubles rather than Lengths, since they can be NA
+  vector<double> m_width, m_height;
+  vector<int> m_label, m_style;
+
+  vector<CharacterVector> m_labels;
+  vector<RObject> m_images;
+  vector<GraphicsContext> m_styles;
+
+  // returns the style handle for a graphics context, adding it to the list of
+  // styles if we haven't seen it before
+  int style_handle(const GraphicsContext &gp) {
+    // search from the back, since the most recently used style is most likely to recur
+    for (size_t i = m_styles.size(); i > 0; i--) {
+      if (static_cast<SEXP>(m_styles[i-1]) == static_cast<SEXP>(gp)) {
+        return i;
+      }
+    }
+    m_styles.push_back(gp);
+    return m_styles.size();
+  }
+
+  void record(Kind kind, Length x, Length y, double width, double height, Length r, int label,
+              const GraphicsContext &gp) {
+    m_kind.push_back(static_cast<int>(kind));
+    m_x.push_back(x);
+    m_y.push_back(y);
+    m_width.push_back(width);
+    m_height.push_back(height);
+    m_r.push_back(r);
+    m_label.push_back(label);
+    m_style.push_back(style_handle(gp));
+  }
+
+  template <class T>
+  static List as_list(const vector<T> &v) {
+    List out(v.size());
+    for (size_t i = 0; i < v.size(); i++) {
+      out[i] = v[i];
+    }
+    return out;
+  }
+
+public:
+  DisplayListRenderer() {}
+  ~DisplayListRenderer() {};
+
+  void text(const CharacterVector &label, Length x, Length y, const GraphicsContext &gp) {
+    m_labels.push_back(label);
+    // text has no size information, since it would have to be measured separately
+    record(Kind::text, x, y, NA_REAL, NA_REAL, 0, m_labels.size(), gp);
+  }
+
+  void raster(RObject image, Length x, Length y, Length width, Length height, bool interpolate = true,
+              const GraphicsContext &gp = R_NilValue) {
+    if (!image.isNULL()) {
+      m_images.push_back(image);
+      record(Kind::raster, x, y, width, height, 0, m_images.size(), gp);
+    }
+  }
+
+  void rect(Length x, Length y, Length width, Length height, const GraphicsContext &gp, Length r = 0) {
+    // skip rects that wouldn't show, just like GridRenderer does
+    if (!is_visible(gp)) {
+      return;
+    }
+    record(Kind::rect, x, y, width, height, r, NA_INTEGER, gp);
+  }
+
+  // Returns the display list as a list with four elements: `primitives`, a data frame
+  // with one row per primitive, and `labels`, `images`, and `styles`, which hold the
+  // objects referenced by the columns `label` and `style` of `primitives`. Indices are
+  // 1-based, for direct use in R. The renderer is reset with each collect() call.
+  List collect() {
+    size_t n = m_kind.size();
+
+    IntegerVector kind(m_kind.begin(), m_kind.end());
+    kind.attr("levels") = CharacterVector::create("text", "rect", "raster");
+    kind.attr("class") = "factor";
+
+    CharacterVector labels(m_labels.size());
+    for (size_t i = 0; i < m_labels.size(); i++) {
+      labels[i] = m_labels[i][0];
+    }
+
+    List primitives = List::create(
+      _["kind"] = kind,
+      _["x"] = NumericVector(m_x.begin(), m_x.end()),
+      _["y"] = NumericVector(m_y.begin(), m_y.end()),
+      _["width"] = NumericVector(m_width.begin(), m_width.end()),
+      _["height"] = NumericVector(m_height.begin(), m_height.end()),
+      _["r"] = NumericVector(m_r.begin(), m_r.end()),
+      _["label"] = IntegerVector(m_label.begin(), m_label.end()),
+      _["style"] = IntegerVector(m_style.begin(), m_style.end())
+    );
+    primitives.attr("class") = "data.frame";
+    // compact row names, as used by R itself
+    primitives.attr("row.names") = IntegerVector::create(NA_INTEGER, -static_cast<int>(n));
+
+    List out = List::create(
+      _["primitives"] = primitives,
+      _["labels"] = labels,
+      _["images"] = as_list(m_images),
+      _["styles"] = as_list(m_styles)
+    );
+
+    m_kind.clear();
+    m_x.clear();
+    m_y.clear();
+    m_width.clear();
+    m_height.clear();
+    m_r.clear();
+    m_label.clear();
+    m_style.clear();
+    m_labels.clear();
+    m_images.clear();
+    m_styles.clear();
+
+    return out;
+  }
+};
+
+#endif
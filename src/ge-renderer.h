@@ -0,0 +1,203 @@
+#ifndef GE_RENDERER_H
+#define GE_RENDERER_H
+
+#include <Rcpp.h>
+using namespace Rcpp;
+
+#include <R_ext/GraphicsEngine.h>
+
+#include <vector>
+#include <cstring>
+using namespace std;
+
+#include "gridtext/grid-renderer.h"
+#include "gridtext/length.h"
+
+/* The GraphicsEngineRenderer class draws the box tree directly onto the
+ * current graphics device, via R's graphics engine, without creating any
+ * grobs. It is meant to be used from within a grob's drawDetails() method,
+ * at which point grid has set up the viewport and graphical parameters
+ * of the grob. The renderer needs three pieces of information from grid:
+ * the current viewport transformation (`grid::current.transform()`), the
+ * current rotation (`grid::current.rotation()`), and the current graphical
+ * parameters (`grid::get.gpar()`). All drawing calls mirror the ones grid
+ * itself makes, so the output is identical to drawing the corresponding
+ * grobs.
+ *
+ * Rounded rectangles are the one exception; grid draws these at the R
+ * level, and they are handed back to grid for drawing.
+ */
+
+class GraphicsEngineRenderer : public GridRenderer {
+private:
+  pGEDevDesc m_dd;
+  NumericMatrix m_transform; // 3x3 viewport transformation, in inches
+  double m_rotation;         // viewport rotation, in degrees
+  List m_parent_gp;          // graphical parameters in effect when drawing starts
+
+  // graphics engine contexts for the graphics contexts seen so far; graphics
+  // contexts are compared by identity, and we hold on to each one we have seen
+  // so its address cannot get reused
+  vector<pair<GraphicsContext, R_GE_gcontext>> m_contexts;
+
+  // converts a location in pt, in the current viewport, into device coordinates
+  void device_location(Length x, Length y, double &xd, double &yd) {
+    // there are 72.27 pt in each in
+    double xin = x / 72.27;
+    double yin = y / 72.27;
+    double xt = xin * m_transform(0, 0) + yin * m_transform(1, 0) + m_transform(2, 0);
+    double yt = xin * m_transform(0, 1) + yin * m_transform(1, 1) + m_transform(2, 1);
+    xd = GEtoDeviceX(xt, GE_INCHES, m_dd);
+    yd = GEtoDeviceY(yt, GE_INCHES, m_dd);
+  }
+
+  // combines the alpha channel of a color with an alpha value, as grid does
+  static rcolor combine_alpha(double alpha, rcolor col) {
+    unsigned int a = (unsigned int) (alpha * R_ALPHA(col));
+    return R_RGBA(R_RED(col), R_GREEN(col), R_BLUE(col), a);
+  }
+
+  // sets up a graphics engine context from a fully resolved gpar list,
+  // following grid's gcontextFromgpar()
+  static void make_gcontext(const List &gp, R_GE_gcontext &gc) {
+    double alpha = as<double>(gp["alpha"]);
+    gc.col = combine_alpha(alpha, (rcolor) as<double>(gp["col"]));
+    gc.fill = combine_alpha(alpha, (rcolor) as<double>(gp["fill"]));
+    gc.gamma = 1;
+    gc.lwd = as<double>(gp["lwd"]) * as<double>(gp["lex"]);
+    SEXP lty = gp["lty"], lineend = gp["lineend"], linejoin = gp["linejoin"];
+    gc.lty = GE_LTYpar(lty, 0);
+    gc.lend = GE_LENDpar(lineend, 0);
+    gc.ljoin = GE_LJOINpar(linejoin, 0);
+    gc.lmitre = as<double>(gp["linemitre"]);
+    gc.cex = as<double>(gp["cex"]);
+    gc.ps = as<double>(gp["fontsize"]);
+    gc.lineheight = as<double>(gp["lineheight"]);
+    gc.fontface = as<int>(gp["font"]);
+    string family = as<string>(gp["fontfamily"]);
+    strncpy(gc.fontfamily, family.c_str(), 200);
+    gc.fontfamily[200] = 0;
+#if R_GE_version >= 14
+    // pattern fills are not supported
+    gc.patternFill = R_NilValue;
+#endif
+  }
+
+  // returns the graphics engine context for a graphics context
+  const R_GE_gcontext &gcontext(const GraphicsContext &gp) {
+    for (auto i_gc = m_contexts.begin(); i_gc != m_contexts.end(); i_gc++) {
+      if (static_cast<SEXP>(i_gc->first) == static_cast<SEXP>(gp)) {
+        return i_gc->second;
+      }
+    }
+
+    // gpar inheritance is resolved at the R level
+    Environment env = Environment::namespace_env("gridtext");
+    Function resolve_gpar = env["resolve_gpar"];
+    List resolved = resolve_gpar(gp, m_parent_gp);
+
+    R_GE_gcontext gc;
+    make_gcontext(resolved, gc);
+    m_contexts.emplace_back(gp, gc);
+    return m_contexts.back().second;
+  }
+
+public:
+  GraphicsEngineRenderer(NumericMatrix transform, double rotation, List parent_gp, double raster_dpi = 0) :
+    GridRenderer(false, false, raster_dpi), m_dd(GEcurrentDevice()), m_transform(transform), m_rotation(rotation), m_parent_gp(parent_gp) {
+    if (m_transform.nrow() != 3 || m_transform.ncol() != 3) {
+      stop("Viewport transformation must be a 3x3 matrix.");
+    }
+    // tell the device that drawing starts
+    GEMode(1, m_dd);
+  }
+
+  ~GraphicsEngineRenderer() {
+    // tell the device that drawing is done
+    GEMode(0, m_dd);
+  }
+
+  void text(const CharacterVector &label, Length x, Length y, const GraphicsContext &gp) {
+    R_GE_gcontext gc = gcontext(gp);
+    double xd, yd;
+    device_location(x, y, xd, yd);
+
+    SEXP str = STRING_ELT(label, 0);
+    cetype_t enc = (gc.fontface == 5) ? CE_SYMBOL : Rf_getCharCE(str);
+    // text is left-aligned on its baseline, just like in text_grob()
+    GEText(xd, yd, CHAR(str), enc, 0, 0, m_rotation, &gc, m_dd);
+  }
+
+  void raster(RObject image, Length x, Length y, Length width, Length height, bool interpolate = true,
+              const GraphicsContext &gp = R_NilValue) {
+    if (image.isNULL()) {
+      return;
+    }
+
+    RObject img = as_raster(prepare_raster(image, width, height));
+    IntegerVector dims(img.attr("dim"));
+    int h = dims[0];
+    int w = dims[1];
+
+    // the graphics engine expects R colors; for raster objects, convert the color strings
+    vector<unsigned int> pixels;
+    unsigned int *data;
+    if (img.inherits("nativeRaster")) {
+      data = (unsigned int *) INTEGER(img);
+    } else {
+      CharacterVector cols(img);
+      pixels.resize(cols.size());
+      for (R_xlen_t i = 0; i < cols.size(); i++) {
+        pixels[i] = CharacterVector::is_na(cols[i]) ? R_TRANWHITE : R_GE_str2col(CHAR(STRING_ELT(cols, i)));
+      }
+      data = pixels.data();
+    }
+
+    R_GE_gcontext gc = gcontext(gp);
+    double xd, yd;
+    device_location(x, y, xd, yd);
+    double wd = GEtoDeviceWidth(width / 72.27, GE_INCHES, m_dd);
+    double hd = GEtoDeviceHeight(height / 72.27, GE_INCHES, m_dd);
+    GERaster(data, w, h, xd, yd, wd, hd, m_rotation, interpolate ? TRUE : FALSE, &gc, m_dd);
+  }
+
+  void rect(Length x, Length y, Length width, Length height, const GraphicsContext &gp, Length r = 0) {
+    // skip drawing if nothing would show anyways
+    if (!is_visible(gp)) {
+      return;
+    }
+
+    if (r >= 0.01) {
+      // rounded rects are drawn by grid; they must not be recorded on grid's
+      // display list, because the enclosing grob redraws them on replay
+      Environment grid = Environment::namespace_env("grid");
+      Function grid_draw = grid["grid.draw"];
+      grid_draw(roundrect_grob(
+        NumericVector(1, x), NumericVector(1, y), NumericVector(1, width), NumericVector(1, height),
+        NumericVector(1, r), gp, R_NilValue
+      ), _["recording"] = false);
+      return;
+    }
+
+    R_GE_gcontext gc = gcontext(gp);
+    if (m_rotation == 0) {
+      double x0, y0, x1, y1;
+      device_location(x, y, x0, y0);
+      x1 = x0 + GEtoDeviceWidth(width / 72.27, GE_INCHES, m_dd);
+      y1 = y0 + GEtoDeviceHeight(height / 72.27, GE_INCHES, m_dd);
+      GERect(x0, y0, x1, y1, &gc, m_dd);
+    } else {
+      // in rotated viewports, grid draws rects as closed polygons
+      double xs[5], ys[5];
+      device_location(x, y, xs[0], ys[0]);
+      device_location(x + width, y, xs[1], ys[1]);
+      device_location(x + width, y + height, xs[2], ys[2]);
+      device_location(x, y + height, xs[3], ys[3]);
+      xs[4] = xs[0];
+      ys[4] = ys[0];
+      GEPolygon(5, xs, ys, &gc, m_dd);
+    }
+  }
+};
+
+#endif
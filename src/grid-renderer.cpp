@@ -1,10 +1,10 @@
 /* R bindings to grid renderer, for unit testing */
 
-#include "grid-renderer.h"
+#include "gridtext/grid-renderer.h"
 
 // [[Rcpp::export]]
-XPtr<GridRenderer> grid_renderer() {
-  XPtr<GridRenderer> gr(new GridRenderer());
+XPtr<GridRenderer> grid_renderer(bool coalesce_text = false, bool batch_rects = false, double raster_dpi = 0) {
+  XPtr<GridRenderer> gr(new GridRenderer(coalesce_text, batch_rects, raster_dpi));
 
   return gr;
 }
@@ -1,17 +1,72 @@
-#include "grid.h"
+#include "gridtext/grid.h"
+#include "gridtext/profiler.h"
+
+#include <vector>
+#include <algorithm> // for min(), max()
+
+/* How grid represents unit objects depends on the R version. Since R 4.0,
+ * simple units are numeric vectors of class `simpleUnit` with an integer
+ * `unit` attribute holding the unit code, and we can construct them directly.
+ * For older versions, we have to call grid::unit(). We determine which case
+ * applies once per session, from a unit object created by grid itself.
+ */
+
+// returns the grid::unit() function; looked up only once per session
+SEXP grid_unit_function() {
+  static SEXP unit_fun = R_NilValue;
+  if (unit_fun == R_NilValue) {
+    Environment env = Environment::namespace_env("grid");
+    unit_fun = env["unit"];
+    R_PreserveObject(unit_fun);
+  }
+  return unit_fun;
+}
 
+// returns unit(1, "pt"), which serves as template for all other pt units
+SEXP unit_pt_template() {
+  static SEXP templ = R_NilValue;
+  if (templ == R_NilValue) {
+    Function unit(grid_unit_function());
+    templ = unit(1, "pt");
+    R_PreserveObject(templ);
+  }
+  return templ;
+}
+
+// replacement for unit(x, "pt")
+// [[Rcpp::export]]
 NumericVector unit_pt(NumericVector x) {
-  // create unit vector by calling back to R
-  Environment env = Environment::namespace_env("grid");
-  Function unit = env["unit"];
-  return unit(x, "pt");
+  GRIDTEXT_PROFILE(units);
+  static int simple_units = -1; // unknown at first
+  RObject templ(unit_pt_template());
+  if (simple_units < 0) {
+    simple_units = templ.inherits("simpleUnit");
+  }
+
+  if (!simple_units) {
+    // create unit vector by calling back to R
+    Function unit(grid_unit_function());
+    return unit(x, "pt");
+  }
+
+  // copy, so we don't add attributes to the input vector
+  NumericVector out(x.begin(), x.end());
+  RObject unit_code = templ.attr("unit");
+  RObject cl = templ.attr("class");
+  out.attr("unit") = unit_code;
+  out.attr("class") = cl;
+
+  return out;
 }
 
+// Overloaded version for Length
 NumericVector unit_pt(Length x) {
   NumericVector out(1, x);
   return unit_pt(out);
 }
 
+// replacement for gpar() with no arguments
+// [[Rcpp::export]]
 List gpar_empty() {
   List out;
   out.attr("class") = "gpar";
@@ -19,11 +74,36 @@ List gpar_empty() {
   return out;
 }
 
-List text_grob(CharacterVector label, NumericVector x_pt, NumericVector y_pt, RObject gp, RObject name) {
+// replacement for textGrop(label, x_pt, y_pt, gp = gpar(), hjust = 0, vjust = 0, default.units = "pt", name = NULL)
+// [[Rcpp::export]]
+List text_grob(CharacterVector label, NumericVector x_pt = 0, NumericVector y_pt = 0,
+               RObject gp = R_NilValue, RObject name = R_NilValue) {
   if (label.size() != 1 || x_pt.size() != 1 || y_pt.size() != 1) {
     stop("Function text_grob() is not vectorized.\n");
   }
 
+  // need to produce a unique name for each grob, otherwise grid gets grumpy
+  static int tg_count = 0;
+  if (name.isNULL()) {
+    tg_count += 1;
+    string s("gridtext.text.");
+    s = s + to_string(tg_count);
+    CharacterVector vs;
+    vs.push_back(s);
+    name = vs;
+  }
+
+  return text_grob_vectorized(label, x_pt, y_pt, gp, name);
+}
+
+// vectorized version of text_grob(); draws all labels with the same graphical parameters
+// [[Rcpp::export]]
+List text_grob_vectorized(CharacterVector label, NumericVector x_pt, NumericVector y_pt,
+                          RObject gp = R_NilValue, RObject name = R_NilValue) {
+  if (x_pt.size() != label.size() || y_pt.size() != label.size()) {
+    stop("Arguments label, x_pt, and y_pt of text_grob_vectorized() must have the same length.\n");
+  }
+
   if (gp.isNULL()) {
     gp = gpar_empty();
   }
@@ -32,7 +112,7 @@ List text_grob(CharacterVector label, NumericVector x_pt, NumericVector y_pt, RO
   static int tg_count = 0;
   if (name.isNULL()) {
     tg_count += 1;
-    string s("gridtext.text.");
+    string s("gridtext.textrun.");
     s = s + to_string(tg_count);
     CharacterVector vs;
     vs.push_back(s);
@@ -55,8 +135,225 @@ List text_grob(CharacterVector label, NumericVector x_pt, NumericVector y_pt, RO
   return out;
 }
 
-List raster_grob(RObject image, NumericVector x_pt, NumericVector y_pt, NumericVector width_pt, NumericVector height_pt,
-                 LogicalVector interpolate, RObject gp, RObject name) {
+// replacement for grDevices::as.raster(image) that returns nativeRaster and raster objects unchanged
+// [[Rcpp::export]]
+RObject as_raster(RObject image) {
+  if (image.inherits("nativeRaster") || image.inherits("raster")) {
+    return image;
+  }
+
+  // convert to raster by calling grDevices::as.raster()
+  static SEXP as_raster_fun = R_NilValue;
+  if (as_raster_fun == R_NilValue) {
+    Environment env = Environment::namespace_env("grDevices");
+    as_raster_fun = env["as.raster"];
+    R_PreserveObject(as_raster_fun);
+  }
+  Function as_raster_r(as_raster_fun);
+  return as_raster_r(image);
+}
+
+/* Downsampling of raster images. nativeRaster and raster objects both store
+ * their pixels row by row, with dim = c(height, width). For nativeRaster
+ * images, each target pixel is the alpha-weighted average of the source
+ * pixels it covers. For raster images, which store colors as strings, we
+ * sample the source pixel closest to the center of each target pixel.
+ */
+
+IntegerVector downsample_native_raster(IntegerVector image, int w, int h, int tw, int th) {
+  IntegerVector out(tw * th);
+
+  for (int i = 0; i < th; i++) {
+    int r0 = (int) ((long) i * h / th);
+    int r1 = max(r0 + 1, (int) ((long) (i + 1) * h / th));
+    for (int j = 0; j < tw; j++) {
+      int c0 = (int) ((long) j * w / tw);
+      int c1 = max(c0 + 1, (int) ((long) (j + 1) * w / tw));
+
+      double red = 0, green = 0, blue = 0, alpha = 0;
+      for (int r = r0; r < r1; r++) {
+        for (int c = c0; c < c1; c++) {
+          unsigned int px = (unsigned int) image[r * w + c];
+          double a = (px >> 24) & 255;
+          red += a * (px & 255);
+          green += a * ((px >> 8) & 255);
+          blue += a * ((px >> 16) & 255);
+          alpha += a;
+        }
+      }
+
+      unsigned int n = (r1 - r0) * (c1 - c0);
+      unsigned int px = 0;
+      if (alpha > 0) {
+        px = ((unsigned int) (red / alpha + 0.5)) |
+          ((unsigned int) (green / alpha + 0.5) << 8) |
+          ((unsigned int) (blue / alpha + 0.5) << 16) |
+          ((unsigned int) (alpha / n + 0.5) << 24);
+      }
+      out[i * tw + j] = (int) px;
+    }
+  }
+  return out;
+}
+
+CharacterVector downsample_string_raster(CharacterVector image, int w, int h, int tw, int th) {
+  CharacterVector out(tw * th);
+
+  for (int i = 0; i < th; i++) {
+    int r = (int) (((long) 2 * i + 1) * h / (2 * th));
+    for (int j = 0; j < tw; j++) {
+      int c = (int) (((long) 2 * j + 1) * w / (2 * tw));
+      out[i * tw + j] = image[r * w + c];
+    }
+  }
+  return out;
+}
+
+RObject downsample_raster_uncached(RObject image, int w, int h, int tw, int th) {
+  RObject out;
+  if (image.inherits("nativeRaster")) {
+    out = downsample_native_raster(image, w, h, tw, th);
+    out.attr("class") = "nativeRaster";
+    out.attr("channels") = image.attr("channels");
+  } else {
+    out = downsample_string_raster(image, w, h, tw, th);
+    out.attr("class") = "raster";
+  }
+  out.attr("dim") = IntegerVector::create(th, tw);
+  return out;
+}
+
+/* Cache of downsampled images, so each image is downsampled only once per
+ * target size. Entries hold weak references to the source images, with the
+ * downsampled image as the value, so the cache doesn't keep source images
+ * alive; once a source image is garbage collected, its key becomes NULL and the
+ * entry is dropped. The cache shares the byte budget of the image cache in
+ * R/read-image.R and is cleared together with it, via image_cache_clear().
+ */
+struct DownsampleEntry {
+  RObject weak_ref;
+  int width_px, height_px;
+  double bytes;
+};
+
+class DownsampleCache {
+  vector<DownsampleEntry> m_entries; // most recently used first
+  double m_bytes;
+
+  void erase(vector<DownsampleEntry>::iterator it) {
+    m_bytes -= it->bytes;
+    m_entries.erase(it);
+  }
+
+public:
+  DownsampleCache() : m_bytes(0) {}
+
+  RObject get(RObject image, int tw, int th) {
+    for (auto it = m_entries.begin(); it != m_entries.end(); ) {
+      SEXP key = R_WeakRefKey(it->weak_ref);
+      if (key == R_NilValue) {
+        // source image is gone
+        erase(it);
+        continue;
+      }
+      if (key == static_cast<SEXP>(image) && it->width_px == tw && it->height_px == th) {
+        DownsampleEntry entry = *it;
+        // move entry to the front, so it gets evicted last
+        m_entries.erase(it);
+        m_entries.insert(m_entries.begin(), entry);
+        return R_WeakRefValue(entry.weak_ref);
+      }
+      it++;
+    }
+    return R_NilValue;
+  }
+
+  // adds an entry, evicting least recently used entries to stay within max_bytes
+  void set(RObject image, int tw, int th, RObject result, double bytes, double max_bytes) {
+    if (bytes > max_bytes) {
+      return;
+    }
+    RObject weak_ref(R_MakeWeakRef(image, result, R_NilValue, FALSE));
+    m_entries.insert(m_entries.begin(), DownsampleEntry{weak_ref, tw, th, bytes});
+    m_bytes += bytes;
+    trim(max_bytes);
+  }
+
+  void trim(double max_bytes) {
+    while (m_bytes > max_bytes && !m_entries.empty()) {
+      erase(m_entries.end() - 1);
+    }
+  }
+
+  void clear() {
+    m_entries.clear();
+    m_bytes = 0;
+  }
+
+  double bytes() const { return m_bytes; }
+};
+
+DownsampleCache &downsample_cache() {
+  static DownsampleCache cache;
+  return cache;
+}
+
+// [[Rcpp::export]]
+double downsample_cache_bytes() {
+  return downsample_cache().bytes();
+}
+
+// [[Rcpp::export]]
+void downsample_cache_trim(double max_bytes) {
+  downsample_cache().trim(max_bytes);
+}
+
+// [[Rcpp::export]]
+void downsample_cache_clear() {
+  downsample_cache().clear();
+}
+
+// reduces a raster or nativeRaster image to at most width_px x height_px pixels;
+// results are cached, see DownsampleCache
+// [[Rcpp::export]]
+RObject downsample_raster(RObject image, int width_px, int height_px) {
+  if (!image.inherits("nativeRaster") && !image.inherits("raster")) {
+    stop("Image must be a raster or nativeRaster object.");
+  }
+
+  RObject dims_obj = image.attr("dim");
+  if (dims_obj.isNULL()) {
+    stop("Cannot extract image dimensions.");
+  }
+  IntegerVector dims(dims_obj);
+  int w = dims[1];
+  int h = dims[0];
+
+  int tw = min(max(width_px, 1), w);
+  int th = min(max(height_px, 1), h);
+  if (tw == w && th == h) {
+    return image;
+  }
+
+  DownsampleCache &cache = downsample_cache();
+  RObject result = cache.get(image, tw, th);
+  if (!result.isNULL()) {
+    return result;
+  }
+
+  result = downsample_raster_uncached(image, w, h, tw, th);
+  // nativeRaster pixels are ints, raster pixels are pointers to shared strings
+  double bytes = static_cast<double>(tw) * th * (image.inherits("nativeRaster") ? sizeof(int) : sizeof(SEXP));
+  Environment env = Environment::namespace_env("gridtext");
+  Function downsample_cache_budget = env["downsample_cache_budget"];
+  cache.set(image, tw, th, result, bytes, as<double>(downsample_cache_budget()));
+  return result;
+}
+
+// replacement for rasterGrop(image, x_pt, y_pt, width_pt, height_pt, gp = gpar(), hjust = 0, vjust = 0, default.units = "pt", interpolate = TRUE, name = NULL)
+// [[Rcpp::export]]
+List raster_grob(RObject image, NumericVector x_pt = 0, NumericVector y_pt = 0, NumericVector width_pt = 0, NumericVector height_pt = 0,
+                 LogicalVector interpolate = true, RObject gp = R_NilValue, RObject name = R_NilValue) {
   if (x_pt.size() != 1 || y_pt.size() != 1 || width_pt.size() != 1 || height_pt.size() != 1) {
     stop("Function raster_grob() is not vectorized.\n");
   }
@@ -72,13 +369,7 @@ List raster_grob(RObject image, NumericVector x_pt, NumericVector y_pt, NumericV
     name = vs;
   }
 
-  RObject raster = image;
-  if (!raster.inherits("nativeRaster")) {
-    // convert to raster by calling grDevices::as.raster()
-    Environment env = Environment::namespace_env("grDevices");
-    Function as_raster = env["as.raster"];
-    raster = as_raster(image);
-  }
+  RObject raster = as_raster(image);
 
   List out = List::create(
     _["raster"] = raster,
@@ -101,12 +392,37 @@ List raster_grob(RObject image, NumericVector x_pt, NumericVector y_pt, NumericV
 
 
 
-List rect_grob(NumericVector x_pt, NumericVector y_pt, NumericVector width_pt, NumericVector height_pt,
-               RObject gp, RObject name) {
+// replacement for rectGrop(x_pt, y_pt, width_pt, height_pt, gp = gpar(), hjust = 0, vjust = 0, default.units = "pt", name = NULL)
+// [[Rcpp::export]]
+List rect_grob(NumericVector x_pt = 0, NumericVector y_pt = 0, NumericVector width_pt = 0, NumericVector height_pt = 0,
+               RObject gp = R_NilValue, RObject name = R_NilValue) {
   if (x_pt.size() != 1 || y_pt.size() != 1 || width_pt.size() != 1 || height_pt.size() != 1) {
     stop("Function rect_grob() is not vectorized.\n");
   }
 
+  // need to produce a unique name for each grob, otherwise grid gets grumpy
+  static int tg_count = 0;
+  if (name.isNULL()) {
+    tg_count += 1;
+    string s("gridtext.rect.");
+    s = s + to_string(tg_count);
+    CharacterVector vs;
+    vs.push_back(s);
+    name = vs;
+  }
+
+  return rect_grob_vectorized(x_pt, y_pt, width_pt, height_pt, gp, name);
+}
+
+// vectorized version of rect_grob(); draws all rects with the same graphical parameters
+// [[Rcpp::export]]
+List rect_grob_vectorized(NumericVector x_pt, NumericVector y_pt, NumericVector width_pt, NumericVector height_pt,
+                          RObject gp = R_NilValue, RObject name = R_NilValue) {
+  R_xlen_t n = x_pt.size();
+  if (y_pt.size() != n || width_pt.size() != n || height_pt.size() != n) {
+    stop("Arguments x_pt, y_pt, width_pt, and height_pt of rect_grob_vectorized() must have the same length.\n");
+  }
+
   if (gp.isNULL()) {
     gp = gpar_empty();
   }
@@ -115,7 +431,7 @@ List rect_grob(NumericVector x_pt, NumericVector y_pt, NumericVector width_pt, N
   static int tg_count = 0;
   if (name.isNULL()) {
     tg_count += 1;
-    string s("gridtext.rect.");
+    string s("gridtext.rectbatch.");
     s = s + to_string(tg_count);
     CharacterVector vs;
     vs.push_back(s);
@@ -139,8 +455,10 @@ List rect_grob(NumericVector x_pt, NumericVector y_pt, NumericVector width_pt, N
   return out;
 }
 
-List roundrect_grob(NumericVector x_pt, NumericVector y_pt, NumericVector width_pt, NumericVector height_pt,
-                    NumericVector r_pt, RObject gp, RObject name) {
+// replacement for roundrectGrop(x_pt, y_pt, width_pt, height_pt, r = unit(r_pt, "pt), gp = gpar(), just = c(0, 0), default.units = "pt", name = NULL)
+// [[Rcpp::export]]
+List roundrect_grob(NumericVector x_pt = 0, NumericVector y_pt = 0, NumericVector width_pt = 0, NumericVector height_pt = 0,
+                    NumericVector r_pt = 5, RObject gp = R_NilValue, RObject name = R_NilValue) {
   if (x_pt.size() != 1 || y_pt.size() != 1 || width_pt.size() != 1 || height_pt.size() != 1 || r_pt.size() != 1) {
     stop("Function roundrect_grob() is not vectorized.\n");
   }
@@ -180,7 +498,47 @@ List roundrect_grob(NumericVector x_pt, NumericVector y_pt, NumericVector width_
   return out;
 }
 
+// returns viewport(just = c(0, 0)), which serves as template for viewport_ll()
+SEXP viewport_ll_template() {
+  static SEXP templ = R_NilValue;
+  if (templ == R_NilValue) {
+    Environment env = Environment::namespace_env("grid");
+    Function viewport = env["viewport"];
+    NumericVector just(2); // c(0, 0)
+    templ = viewport(_["just"] = just);
+    R_PreserveObject(templ);
+  }
+  return templ;
+}
+
+// replacement for viewport(x, y, just = c(0, 0), angle = angle, name = name)
+// [[Rcpp::export]]
+List viewport_ll(RObject x, RObject y, double angle = 0, RObject name = R_NilValue) {
+  // need to produce a unique name for each viewport, as grid does
+  static int vp_count = 0;
+  if (name.isNULL()) {
+    vp_count += 1;
+    string s("gridtext.vp.");
+    s = s + to_string(vp_count);
+    CharacterVector vs;
+    vs.push_back(s);
+    name = vs;
+  }
+
+  // all other fields of the viewport are the same as in the template, so we
+  // only need to fill in the ones that differ
+  List out = clone(List(viewport_ll_template()));
+  out["x"] = x;
+  out["y"] = y;
+  out["angle"] = angle;
+  out["name"] = name;
+
+  return out;
+}
+
 
+// replacement for editGrob(grob, x = x, y = y)
+// [[Rcpp::export]]
 RObject set_grob_coords(RObject grob, NumericVector x, NumericVector y) {
   as<List>(grob)["x"] = x;
   as<List>(grob)["y"] = y;
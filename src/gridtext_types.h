@@ -8,7 +8,7 @@
  * an XPtr. It is not used anywhere else in the C++ part of the code.
  */
 
-#include "layout.h"
-#include "grid-renderer.h"
+#include "gridtext/layout.h"
+#include "gridtext/grid-renderer.h"
 
 #endif
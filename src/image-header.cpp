@@ -0,0 +1,154 @@
+#include <Rcpp.h>
+using namespace Rcpp;
+
+#include <fstream>
+#include <string>
+using namespace std;
+
+/* Functions to determine the pixel dimensions of PNG and JPEG images by
+ * reading only the image header. This allows us to lay out images without
+ * decoding them. Images can come either from a file or from a raw vector
+ * (e.g., downloaded from a URL).
+ */
+
+// reads bytes sequentially from a file
+class FileSource {
+private:
+  ifstream m_in;
+
+public:
+  FileSource(const string &path) : m_in(path.c_str(), ios::in | ios::binary) {}
+
+  bool good() { return m_in.good(); }
+
+  bool read(unsigned char *buf, size_t n) {
+    m_in.read(reinterpret_cast<char *>(buf), n);
+    return m_in.good();
+  }
+
+  bool skip(size_t n) {
+    m_in.seekg(n, ios::cur);
+    return m_in.good();
+  }
+};
+
+// reads bytes sequentially from a raw vector
+class RawSource {
+private:
+  RawVector m_data;
+  size_t m_pos;
+
+public:
+  RawSource(RawVector data) : m_data(data), m_pos(0) {}
+
+  bool good() { return true; }
+
+  bool read(unsigned char *buf, size_t n) {
+    if (m_pos + n > (size_t) m_data.size()) return false;
+    for (size_t i = 0; i < n; i++) {
+      buf[i] = m_data[m_pos + i];
+    }
+    m_pos += n;
+    return true;
+  }
+
+  bool skip(size_t n) {
+    m_pos += n;
+    return m_pos <= (size_t) m_data.size();
+  }
+};
+
+inline unsigned int read_be(const unsigned char *buf, int n) {
+  unsigned int x = 0;
+  for (int i = 0; i < n; i++) {
+    x = (x << 8) | buf[i];
+  }
+  return x;
+}
+
+// The PNG signature is followed by the IHDR chunk, which holds width and height.
+template <class Source>
+bool png_dimensions(Source &src, unsigned int &width, unsigned int &height) {
+  static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+
+  unsigned char buf[24];
+  if (!src.read(buf, 24)) return false;
+  for (int i = 0; i < 8; i++) {
+    if (buf[i] != signature[i]) return false;
+  }
+  if (buf[12] != 'I' || buf[13] != 'H' || buf[14] != 'D' || buf[15] != 'R') return false;
+
+  width = read_be(buf + 16, 4);
+  height = read_be(buf + 20, 4);
+  return true;
+}
+
+// In JPEG files, width and height are stored in the start-of-frame segment,
+// which may be preceded by any number of other segments (EXIF data, etc.).
+template <class Source>
+bool jpeg_dimensions(Source &src, unsigned int &width, unsigned int &height) {
+  unsigned char buf[7];
+  if (!src.read(buf, 2) || buf[0] != 0xFF || buf[1] != 0xD8) return false;
+
+  while (true) {
+    // find next marker, skipping any fill bytes
+    if (!src.read(buf, 1) || buf[0] != 0xFF) return false;
+    unsigned char marker = 0xFF;
+    while (marker == 0xFF) {
+      if (!src.read(&marker, 1)) return false;
+    }
+
+    // markers without payload
+    if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8)) continue;
+    // end of image or start of scan before any frame header
+    if (marker == 0xD9 || marker == 0xDA) return false;
+
+    if (!src.read(buf, 2)) return false;
+    unsigned int length = read_be(buf, 2);
+    if (length < 2) return false;
+
+    // SOF0 to SOF15, except DHT (0xC4), JPG (0xC8), and DAC (0xCC)
+    if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+      if (!src.read(buf, 5)) return false;
+      height = read_be(buf + 1, 2);
+      width = read_be(buf + 3, 2);
+      return true;
+    }
+
+    if (!src.skip(length - 2)) return false;
+  }
+}
+
+template <class Source>
+RObject image_dimensions_from(Source &src, bool is_png) {
+  unsigned int width = 0, height = 0;
+  bool ok = is_png ? png_dimensions(src, width, height) : jpeg_dimensions(src, width, height);
+
+  if (!ok || width == 0 || height == 0) {
+    return R_NilValue;
+  }
+
+  return IntegerVector::create(width, height);
+}
+
+// Returns the width and height in pixels of a PNG or JPEG image, or NULL if
+// the image header cannot be read. `source` is either a file name or a raw
+// vector holding the image data.
+// [[Rcpp::export]]
+RObject image_header_size(RObject source, bool is_png = true) {
+  if (TYPEOF(source) == RAWSXP) {
+    RawSource src(source);
+    return image_dimensions_from(src, is_png);
+  }
+
+  CharacterVector path(source);
+  if (path.size() != 1) {
+    stop("Image source must be a single file name or a raw vector.");
+  }
+
+  FileSource src(as<string>(path[0]));
+  if (!src.good()) {
+    return R_NilValue;
+  }
+  return image_dimensions_from(src, is_png);
+}
@@ -0,0 +1,134 @@
+#include <Rcpp.h>
+using namespace Rcpp;
+
+#include <chrono>
+#include <vector>
+using namespace std;
+
+#include "gridtext/profiler.h"
+
+/* State of the profiler; see gridtext/profiler.h. Times are recorded in seconds,
+ * relative to the first phase timed since the last reset.
+ */
+
+typedef chrono::steady_clock ProfileClock;
+
+struct ProfileFrame {
+  ProfilePhase phase;
+  ProfileClock::time_point start;
+  double children; // time spent in nested phases
+};
+
+struct ProfileEvent {
+  int phase;
+  double start, duration;
+};
+
+// at most this many events are kept for the trace, to bound memory use
+const size_t profile_max_events = 1000000;
+
+struct ProfilerState {
+  bool started = false;
+  ProfileClock::time_point epoch;
+  vector<ProfileFrame> stack;
+  double calls[profile_phase_count] = {0};
+  double total[profile_phase_count] = {0};
+  double self[profile_phase_count] = {0};
+  vector<ProfileEvent> events;
+  double dropped = 0;
+};
+
+ProfilerState &profiler_state() {
+  static ProfilerState state;
+  return state;
+}
+
+bool profiler_enabled() {
+  SEXP opt = Rf_GetOption1(Rf_install("gridtext.profile"));
+  return Rf_isLogical(opt) && Rf_length(opt) == 1 && LOGICAL(opt)[0] == TRUE;
+}
+
+bool profiler_enter(ProfilePhase phase) {
+  ProfilerState &ps = profiler_state();
+  if (ps.stack.empty() && !profiler_enabled()) {
+    return false;
+  }
+
+  ProfileClock::time_point now = ProfileClock::now();
+  if (!ps.started) {
+    ps.started = true;
+    ps.epoch = now;
+  }
+  ps.stack.push_back({phase, now, 0});
+  return true;
+}
+
+void profiler_exit() {
+  ProfilerState &ps = profiler_state();
+  if (ps.stack.empty()) {
+    return; // profiler was reset while the phase was active
+  }
+
+  ProfileFrame f = ps.stack.back();
+  ps.stack.pop_back();
+  double duration = chrono::duration<double>(ProfileClock::now() - f.start).count();
+  int i = static_cast<int>(f.phase);
+  ps.calls[i] += 1;
+  ps.total[i] += duration;
+  ps.self[i] += duration - f.children;
+  if (!ps.stack.empty()) {
+    ps.stack.back().children += duration;
+  }
+
+  if (ps.events.size() < profile_max_events) {
+    ps.events.push_back({i, chrono::duration<double>(f.start - ps.epoch).count(), duration});
+  } else {
+    ps.dropped += 1;
+  }
+}
+
+/* Functions called from R */
+
+// [[Rcpp::export]]
+bool profiler_enter_phase(int phase) {
+  if (phase < 0 || phase >= profile_phase_count) {
+    stop("Unknown profiling phase.");
+  }
+  return profiler_enter(static_cast<ProfilePhase>(phase));
+}
+
+// [[Rcpp::export]]
+void profiler_exit_phase() {
+  profiler_exit();
+}
+
+// [[Rcpp::export]]
+void profiler_reset() {
+  profiler_state() = ProfilerState();
+}
+
+// [[Rcpp::export]]
+List profiler_summary() {
+  ProfilerState &ps = profiler_state();
+  return List::create(
+    _["calls"] = NumericVector(ps.calls, ps.calls + profile_phase_count),
+    _["total"] = NumericVector(ps.total, ps.total + profile_phase_count),
+    _["self"] = NumericVector(ps.self, ps.self + profile_phase_count)
+  );
+}
+
+// [[Rcpp::export]]
+List profiler_events() {
+  ProfilerState &ps = profiler_state();
+  size_t n = ps.events.size();
+  IntegerVector phase(n);
+  NumericVector start(n), duration(n);
+  for (size_t i = 0; i < n; i++) {
+    phase[i] = ps.events[i].phase;
+    start[i] = ps.events[i].start;
+    duration[i] = ps.events[i].duration;
+  }
+  return List::create(
+    _["phase"] = phase, _["start"] = start, _["duration"] = duration, _["dropped"] = ps.dropped
+  );
+}
@@ -0,0 +1,108 @@
+#ifndef STUB_RENDERER_H
+#define STUB_RENDERER_H
+
+#include <Rcpp.h>
+using namespace Rcpp;
+
+#include "gridtext/length.h"
+#include "gridtext/layout.h"
+
+/* The StubRenderer class is a renderer that doesn't need a graphics
+ * device. Text is measured from a fixed table of character widths,
+ * so results are deterministic, and nothing is actually drawn; the
+ * renderer merely counts the primitives it receives and keeps a
+ * checksum of their coordinates. This is useful for measuring the
+ * performance of the layout engine by itself, e.g., in benchmarks.
+ * The StubRenderer is not used by the R package.
+ */
+
+// The graphics context of the stub renderer is just the font size, in pt
+struct StubGraphicsContext {
+  double fontsize;
+
+  StubGraphicsContext(double fs = 12) : fontsize(fs) {}
+};
+
+class StubRenderer {
+public:
+  typedef StubGraphicsContext GraphicsContext;
+
+private:
+  size_t m_text_count, m_rect_count, m_raster_count;
+  double m_checksum;
+
+  // optional clip rectangle, as in GridRenderer
+  bool m_clip;
+  Length m_clip_x0, m_clip_y0, m_clip_x1, m_clip_y1;
+
+  // width of a character, in units of 1/1000 of the font size; printable ASCII
+  // characters use the metrics of Helvetica, all other bytes use a default width
+  static double char_width(unsigned char c) {
+    static const short widths[95] = {
+      278, 278, 355, 556, 556, 889, 667, 191, 333, 333, 389, 584, 278, 333, 278, 278, //  !"#$%&'()*+,-./
+      556, 556, 556, 556, 556, 556, 556, 556, 556, 556, 278, 278, 584, 584, 584, 556, // 0123456789:;<=>?
+      1015, 667, 667, 722, 722, 667, 611, 778, 722, 278, 500, 667, 556, 833, 722, 778, // @ABCDEFGHIJKLMNO
+      667, 778, 722, 667, 611, 722, 667, 944, 667, 667, 611, 278, 278, 278, 469, 556,  // PQRSTUVWXYZ[\]^_
+      333, 556, 556, 500, 556, 556, 278, 556, 556, 222, 222, 500, 222, 833, 556, 556,  // `abcdefghijklmno
+      556, 556, 333, 500, 278, 556, 500, 722, 500, 500, 500, 334, 260, 334, 584        // pqrstuvwxyz{|}~
+    };
+
+    if (c < 32 || c > 126) {
+      return 556;
+    }
+    return widths[c - 32];
+  }
+
+public:
+  StubRenderer() :
+    m_text_count(0), m_rect_count(0), m_raster_count(0), m_checksum(0),
+    m_clip(false), m_clip_x0(0), m_clip_y0(0), m_clip_x1(0), m_clip_y1(0) {}
+
+  static TextDetails text_details(const CharacterVector &label, const GraphicsContext &gp) {
+    const char *s = CHAR(STRING_ELT(label, 0));
+    double width = 0;
+    for (; *s != 0; s++) {
+      width += char_width(*s);
+    }
+
+    double scale = gp.fontsize / 1000;
+    // ascent and descent of Helvetica
+    return TextDetails(width * scale, 718 * scale, 207 * scale, char_width(' ') * scale);
+  }
+
+  void set_clip(Length x0, Length y0, Length x1, Length y1) {
+    m_clip = true;
+    m_clip_x0 = x0;
+    m_clip_y0 = y0;
+    m_clip_x1 = x1;
+    m_clip_y1 = y1;
+  }
+
+  bool is_clipped(Length x0, Length y0, Length x1, Length y1) const {
+    return m_clip && (x1 < m_clip_x0 || x0 > m_clip_x1 || y1 < m_clip_y0 || y0 > m_clip_y1);
+  }
+
+  void text(const CharacterVector &, Length x, Length y, const GraphicsContext &) {
+    m_text_count++;
+    m_checksum += x + y;
+  }
+
+  void raster(RObject, Length x, Length y, Length width, Length height, bool = true,
+              const GraphicsContext & = GraphicsContext()) {
+    m_raster_count++;
+    m_checksum += x + y + width + height;
+  }
+
+  void rect(Length x, Length y, Length width, Length height, const GraphicsContext &, Length = 0) {
+    m_rect_count++;
+    m_checksum += x + y + width + height;
+  }
+
+  size_t text_count() { return m_text_count; }
+  size_t rect_count() { return m_rect_count; }
+  size_t raster_count() { return m_raster_count; }
+  // sum of all coordinates received; useful to check that two layouts agree
+  double checksum() { return m_checksum; }
+};
+
+#endif
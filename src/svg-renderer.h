@@ -0,0 +1,162 @@
+#ifndef SVG_RENDERER_H
+#define SVG_RENDERER_H
+
+#include <Rcpp.h>
+using namespace Rcpp;
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include <utility>
+using namespace std;
+
+#include "gridtext/grid-renderer.h"
+#include "gridtext/length.h"
+
+/* The SvgRenderer class writes the box tree as SVG <text>, <rect>, and <image>
+ * elements into a string buffer, without creating any grobs or needing a
+ * graphics device for drawing. Text has been measured already during layout,
+ * so positions are the same as when drawing via grid. All lengths are in pt.
+ * SVG coordinates run from top to bottom, so y coordinates are flipped
+ * relative to the height of the drawing.
+ *
+ * Translating graphics contexts into SVG style attributes and encoding images
+ * as PNG is done at the R level, once per graphics context or image.
+ */
+
+class SvgRenderer : public GridRenderer {
+private:
+  ostringstream m_out;
+  Length m_height; // total height of the drawing, used to flip y coordinates
+
+  // style attributes and image data for the graphics contexts and images seen so far;
+  // these are compared by identity, and we hold on to each one so its address
+  // cannot get reused
+  vector<pair<GraphicsContext, string>> m_text_styles, m_rect_styles;
+  vector<pair<RObject, string>> m_images;
+
+  template <class T>
+  static const string &lookup(vector<pair<T, string>> &cache, const T &obj, const char *r_fun) {
+    for (auto i = cache.begin(); i != cache.end(); i++) {
+      if (static_cast<SEXP>(i->first) == static_cast<SEXP>(obj)) {
+        return i->second;
+      }
+    }
+
+    Environment env = Environment::namespace_env("gridtext");
+    Function f = env[r_fun];
+    cache.emplace_back(obj, as<string>(f(obj)));
+    return cache.back().second;
+  }
+
+  // returns a data URI holding the image as PNG
+  const string &image_href(RObject image) {
+    for (auto i = m_images.begin(); i != m_images.end(); i++) {
+      if (static_cast<SEXP>(i->first) == static_cast<SEXP>(image)) {
+        return i->second;
+      }
+    }
+
+    Environment env = Environment::namespace_env("gridtext");
+    Function svg_image_png = env["svg_image_png"];
+    RawVector png = svg_image_png(image);
+    m_images.emplace_back(image, "data:image/png;base64," + base64_encode(png));
+    return m_images.back().second;
+  }
+
+  static string base64_encode(const RawVector &data) {
+    static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    size_t n = data.size();
+    string out;
+    out.reserve(4 * ((n + 2) / 3));
+    for (size_t i = 0; i < n; i += 3) {
+      unsigned int b = data[i] << 16;
+      if (i + 1 < n) b |= data[i + 1] << 8;
+      if (i + 2 < n) b |= data[i + 2];
+      out += chars[(b >> 18) & 63];
+      out += chars[(b >> 12) & 63];
+      out += (i + 1 < n) ? chars[(b >> 6) & 63] : '=';
+      out += (i + 2 < n) ? chars[b & 63] : '=';
+    }
+    return out;
+  }
+
+  static void write_escaped(ostringstream &out, const char *s) {
+    for (; *s != 0; s++) {
+      switch (*s) {
+      case '&': out << "&amp;"; break;
+      case '<': out << "&lt;"; break;
+      case '>': out << "&gt;"; break;
+      case '"': out << "&quot;"; break;
+      case '\'': out << "&apos;"; break;
+      default: out << *s;
+      }
+    }
+  }
+
+public:
+  SvgRenderer(Length height, double raster_dpi = 0) :
+    GridRenderer(false, false, raster_dpi), m_height(height) {
+    // two decimals are plenty for lengths in pt
+    m_out.setf(ios::fixed);
+    m_out.precision(2);
+  }
+  ~SvgRenderer() {};
+
+  void text(const CharacterVector &label, Length x, Length y, const GraphicsContext &gp) {
+    m_out << "<text x='" << x << "' y='" << m_height - y << "' style='"
+          << lookup(m_text_styles, gp, "svg_text_style") << "'>";
+    write_escaped(m_out, Rf_translateCharUTF8(STRING_ELT(label, 0)));
+    m_out << "</text>\n";
+  }
+
+  void raster(RObject image, Length x, Length y, Length width, Length height, bool interpolate = true,
+              const GraphicsContext & = R_NilValue) {
+    if (image.isNULL()) {
+      return;
+    }
+
+    m_out << "<image x='" << x << "' y='" << m_height - y - height
+          << "' width='" << width << "' height='" << height << "' preserveAspectRatio='none'";
+    if (!interpolate) {
+      m_out << " image-rendering='pixelated'";
+    }
+    m_out << " xlink:href='" << image_href(prepare_raster(image, width, height)) << "'/>\n";
+  }
+
+  void rect(Length x, Length y, Length width, Length height, const GraphicsContext &gp, Length r = 0) {
+    // skip drawing if nothing would show anyways
+    if (!is_visible(gp)) {
+      return;
+    }
+
+    m_out << "<rect x='" << x << "' y='" << m_height - y - height
+          << "' width='" << width << "' height='" << height << "'";
+    if (r >= 0.01) {
+      m_out << " rx='" << r << "' ry='" << r << "'";
+    }
+    m_out << " style='" << lookup(m_rect_styles, gp, "svg_rect_style") << "'/>\n";
+  }
+
+  // returns the complete SVG document, of the given width; the renderer is reset
+  // with each call
+  string collect_svg(Length width) {
+    ostringstream doc;
+    doc.setf(ios::fixed);
+    doc.precision(2);
+    doc << "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink'"
+        << " width='" << width << "pt' height='" << m_height << "pt'"
+        << " viewBox='0 0 " << width << " " << m_height << "'>\n"
+        << m_out.str() << "</svg>\n";
+
+    m_out.str("");
+    m_text_styles.clear();
+    m_rect_styles.clear();
+    m_images.clear();
+
+    return doc.str();
+  }
+};
+
+#endif